@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+    BandChain.cpp
+
+  ==============================================================================
+*/
+
+#include "BandChain.h"
+
+BandChain::Biquad BandChain::design(const BandSettings& band, double sampleRate, bool& rejected)
+{
+    using ArrayCoefficients = juce::dsp::IIR::ArrayCoefficients<float>;
+
+    // The ArrayCoefficients versions hand back plain arrays instead of allocating a Coefficients object
+    const auto freq = juce::jmin(band.freq, static_cast<float>(sampleRate * 0.49));
+    const auto gain = juce::Decibels::decibelsToGain(band.gainInDecibels);
+
+    std::array<float, 6> raw; // b0, b1, b2, a0, a1, a2
+
+    switch (band.type)
+    {
+    case Band_LowShelf:
+        raw = ArrayCoefficients::makeLowShelf(sampleRate, freq, band.quality, gain);
+        break;
+    case Band_HighShelf:
+        raw = ArrayCoefficients::makeHighShelf(sampleRate, freq, band.quality, gain);
+        break;
+    case Band_Notch:
+        raw = ArrayCoefficients::makeNotch(sampleRate, freq, band.quality);
+        break;
+    case Band_Peak:
+    default:
+        raw = ArrayCoefficients::makePeakFilter(sampleRate, freq, band.quality, gain);
+        break;
+    }
+
+    // something in the settings is out of range, better flat than exploding
+    rejected = !isStableBiquad(raw);
+
+    if (rejected)
+        raw = passThroughBiquad;
+
+    const auto a0 = 1.f / raw[3];
+    return { raw[0] * a0, raw[1] * a0, raw[2] * a0, raw[4] * a0, raw[5] * a0 };
+}
+
+void BandChain::setBands(const BandSettingsArray& bands, double sampleRate)
+{
+    std::array<Biquad, numParametricBands> newCoefficients{};
+    std::array<int, numParametricBands> newActiveBands{};
+    int newActive = 0;
+    numRejected = 0;
+
+    for (int band = 0; band < numParametricBands; ++band)
+    {
+        if (!bands[band].enabled)
+            continue;
+
+        bool rejected = false;
+        newCoefficients[newActive] = design(bands[band], sampleRate, rejected);
+        newActiveBands[newActive++] = band;
+
+        numRejected += rejected ? 1 : 0;
+    }
+
+    load(newCoefficients, newActiveBands, newActive);
+}
+
+void BandChain::copyCoefficientsFrom(const BandChain& other)
+{
+    load(other.coefficients, other.activeBands, other.numActive);
+}
+
+void BandChain::load(const std::array<Biquad, numParametricBands>& newCoefficients,
+    const std::array<int, numParametricBands>& newActiveBands,
+    int newActive)
+{
+    std::array<State, numParametricBands * maxChannels> newState{};
+
+    // carry the state over if the band was already running, otherwise it starts from silence
+    for (int newSlot = 0; newSlot < newActive; ++newSlot)
+    {
+        for (int slot = 0; slot < numActive; ++slot)
+        {
+            if (activeBands[slot] == newActiveBands[newSlot])
+            {
+                for (int channel = 0; channel < maxChannels; ++channel)
+                    newState[newSlot * maxChannels + channel] = state[slot * maxChannels + channel];
+                break;
+            }
+        }
+    }
+
+    coefficients = newCoefficients;
+    activeBands = newActiveBands;
+    state = newState;
+    numActive = newActive;
+}
+
+void BandChain::reset()
+{
+    state.fill({ 0.f, 0.f });
+}
+
+void BandChain::process(juce::dsp::AudioBlock<float>& block)
+{
+    const auto numChannels = juce::jmin(static_cast<int>(block.getNumChannels()), maxChannels);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        processChannel(block.getChannelPointer(static_cast<size_t>(channel)), static_cast<int>(block.getNumSamples()), channel);
+}
+
+void BandChain::processChannel(float* samples, int numSamples, int channel)
+{
+    for (int slot = 0; slot < numActive; ++slot)
+    {
+        const auto c = coefficients[slot];
+        auto s = state[slot * maxChannels + channel];
+
+        // transposed direct form II, the state lives in registers for the whole block
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto x = samples[i];
+            const auto y = c.b0 * x + s.z1;
+            s.z1 = c.b1 * x - c.a1 * y + s.z2;
+            s.z2 = c.b2 * x - c.a2 * y;
+            samples[i] = y;
+        }
+
+        // same as IIR::Filter, a silent tail gets cut off here rather than run on in the subnormal range
+        juce::dsp::util::snapToZero(s.z1);
+        juce::dsp::util::snapToZero(s.z2);
+
+        state[slot * maxChannels + channel] = s;
+    }
+}
+
+double BandChain::getMagnitudeForFrequency(double frequency, double sampleRate) const
+{
+    const auto zInverse = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate);
+
+    double magnitude = 1.0;
+
+    for (int slot = 0; slot < numActive; ++slot)
+        magnitude *= std::abs(evaluateBiquad(getBiquad(slot), zInverse));
+
+    return magnitude;
+}
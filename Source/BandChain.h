@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    BandChain.h
+
+    The extra parametric bands. Rather than a ProcessorChain with a bypassable
+    slot per band, the enabled bands are packed into one flat coefficient array
+    and one flat state array, so the per-sample cost only grows with the bands
+    that are actually switched on.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+constexpr int numParametricBands = 24;
+
+// A biquad as b0, b1, b2, a0, a1, a2 is usable if everything is finite and both poles
+// are inside the unit circle, i.e. (normalised) |a2| < 1 and |a1| < 1 + a2.
+// The designers fall back to a pass through section rather than run one that isn't, and count it.
+inline bool isStableBiquad(const std::array<float, 6>& c)
+{
+    for (auto value : c)
+        if (!std::isfinite(value))
+            return false;
+
+    if (c[3] == 0.f)
+        return false;
+
+    const auto a1 = c[4] / c[3];
+    const auto a2 = c[5] / c[3];
+
+    return std::abs(a2) < 1.f && std::abs(a1) < 1.f + a2;
+}
+
+constexpr std::array<float, 6> passThroughBiquad{ 1.f, 0.f, 0.f, 1.f, 0.f, 0.f };
+
+// Response of one raw biquad at z^-1 = e^-jw, and its group delay in samples if asked for
+// (Re(z N'(z) / N(z)) - Re(z D'(z) / D(z))). Everything that draws, fits or reports a response
+// goes through this, over a grid of e^-jw it works out once.
+inline std::complex<double> evaluateBiquad(const std::array<float, 6>& c, std::complex<double> zInverse, double* groupDelay = nullptr)
+{
+    const double b0 = c[0], b1 = c[1], b2 = c[2], a0 = c[3], a1 = c[4], a2 = c[5];
+    const auto zInverse2 = zInverse * zInverse;
+
+    const auto numerator = b0 + b1 * zInverse + b2 * zInverse2;
+    const auto denominator = a0 + a1 * zInverse + a2 * zInverse2;
+
+    if (groupDelay != nullptr)
+    {
+        const auto numeratorDelay = numerator == 0.0 ? 0.0 : std::real((b1 * zInverse + 2.0 * b2 * zInverse2) / numerator);
+        *groupDelay = numeratorDelay - std::real((a1 * zInverse + 2.0 * a2 * zInverse2) / denominator);
+    }
+
+    return numerator / denominator;
+}
+
+enum BandType
+{
+    Band_Peak,
+    Band_LowShelf,
+    Band_HighShelf,
+    Band_Notch
+};
+
+struct BandSettings
+{
+    bool enabled{ false };
+    int type{ BandType::Band_Peak };
+    float freq{ 1000.f }, gainInDecibels{ 0 }, quality{ 1.f };
+
+    bool operator==(const BandSettings& other) const
+    {
+        return enabled == other.enabled && type == other.type && freq == other.freq
+            && gainInDecibels == other.gainInDecibels && quality == other.quality;
+    }
+
+    bool operator!=(const BandSettings& other) const { return !(*this == other); }
+};
+
+using BandSettingsArray = std::array<BandSettings, numParametricBands>;
+
+class BandChain
+{
+public:
+    static constexpr int maxChannels = 2;
+
+    // Designs the enabled bands and packs them to the front, state follows its band around
+    // Doesn't allocate, so it's fine to call from the audio thread
+    void setBands(const BandSettingsArray& bands, double sampleRate);
+
+    // Takes over the coefficients designed by another chain (on another thread), keeping our own state
+    void copyCoefficientsFrom(const BandChain& other);
+
+    void reset();
+
+    // Runs every active band over the block in place, one band at a time over the whole block
+    void process(juce::dsp::AudioBlock<float>& block);
+
+    // Just one channel's state, so different channels can run on different threads
+    void processChannel(float* samples, int numSamples, int channel);
+
+    int getNumActiveBands() const { return numActive; }
+
+    // Enabled bands the last setBands had to turn into pass throughs, see isStableBiquad
+    int getNumRejectedBands() const { return numRejected; }
+
+    // Coefficients of an active slot as b0, b1, b2, a0, a1, a2
+    std::array<float, 6> getBiquad(int slot) const
+    {
+        const auto& c = coefficients[slot];
+        return { c.b0, c.b1, c.b2, 1.f, c.a1, c.a2 };
+    }
+
+    // Which of the bands sits in an active slot
+    int getBandIndex(int slot) const { return activeBands[slot]; }
+
+    // Product of the active bands, for drawing the response curve
+    double getMagnitudeForFrequency(double frequency, double sampleRate) const;
+
+private:
+    struct Biquad { float b0, b1, b2, a1, a2; }; // normalised so a0 == 1
+    struct State { float z1, z2; };
+
+    static Biquad design(const BandSettings& band, double sampleRate, bool& rejected);
+
+    void load(const std::array<Biquad, numParametricBands>& newCoefficients,
+        const std::array<int, numParametricBands>& newActiveBands,
+        int newActive);
+
+    std::array<Biquad, numParametricBands> coefficients{};
+    std::array<State, numParametricBands * maxChannels> state{}; // [slot * maxChannels + channel]
+    std::array<int, numParametricBands> activeBands{}; // which band sits in each slot
+    int numActive = 0;
+    int numRejected = 0;
+};
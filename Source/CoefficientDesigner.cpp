@@ -0,0 +1,276 @@
+/*
+  ==============================================================================
+
+    CoefficientDesigner.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientDesigner.h"
+
+CoefficientDesigner::CoefficientDesigner(juce::AudioProcessorValueTreeState& apvtsToUse)
+    : juce::Thread("Coefficient Designer"), apvts(apvtsToUse)
+{
+    for (auto* param : apvts.processor.getParameters())
+    {
+        if (auto* paramWithID = dynamic_cast<juce::AudioProcessorParameterWithID*>(param))
+        {
+            parameterIDs.add(paramWithID->paramID);
+            apvts.addParameterListener(paramWithID->paramID, this);
+        }
+    }
+
+    // every slot starts out as the defaults
+    const auto values = readParameterValues();
+
+    for (auto& slotValues : snapshotValues)
+        slotValues = values;
+}
+
+CoefficientDesigner::~CoefficientDesigner()
+{
+    for (auto& id : parameterIDs)
+        apvts.removeParameterListener(id, this);
+
+    cancelPendingUpdate();
+
+    signalThreadShouldExit();
+    wake.post();
+    stopThread(1000);
+}
+
+void CoefficientDesigner::prepare(double sampleRate)
+{
+    // The worker only touches the write side with snapshotLock held, so it can keep running through this
+    const juce::ScopedLock sl(snapshotLock);
+
+    needsRedesign = false;
+
+    // new rate, so all the prepared slots need doing again. At the same rate they're still good.
+    if (sampleRate != snapshotSampleRate)
+    {
+        hostSampleRate = sampleRate;
+        snapshotSampleRate = sampleRate;
+
+        for (int slot = 0; slot < numSnapshots; ++slot)
+            designSnapshot(slot);
+    }
+
+    auto& target = slots[static_cast<size_t>(writeIndex)];
+    design(target, getChainSettings(apvts));
+    snapshotCoefficients[static_cast<size_t>(activeSnapshot)] = target;
+
+    publish();
+
+    if (!isThreadRunning())
+        startThread();
+}
+
+const ChainCoefficients* CoefficientDesigner::getNewCoefficients()
+{
+    if ((latest.load(std::memory_order_relaxed) & newDataFlag) == 0)
+        return nullptr;
+
+    readIndex = latest.exchange(readIndex, std::memory_order_acq_rel) & ~newDataFlag;
+    return &slots[static_cast<size_t>(readIndex)];
+}
+
+void CoefficientDesigner::triggerRedesign()
+{
+    needsRedesign = true;
+    wake.post();
+}
+
+void CoefficientDesigner::beginBulkChange()
+{
+    ++bulkChangeDepth;
+}
+
+void CoefficientDesigner::endBulkChange()
+{
+    // nothing moved, nothing to design
+    if (--bulkChangeDepth == 0 && needsRedesign.load())
+        wake.post();
+}
+
+void CoefficientDesigner::parameterChanged(const juce::String&, float)
+{
+    // Can come in on any thread including the audio one, which is fine for posting the semaphore.
+    // Only the change that raises the flag posts, the rest of a sweep gets picked up by that design
+    // or the one straight after it. During a bulk change whoever closes it does the waking.
+    if (!needsRedesign.exchange(true) && bulkChangeDepth.load() == 0)
+        wake.post();
+}
+
+void CoefficientDesigner::run()
+{
+    while (!threadShouldExit())
+    {
+        wake.wait();
+
+        if (threadShouldExit())
+            break;
+
+        // while a bulk change or a snapshot push is going on the parameters are half way, leave them be.
+        // The flag stays set, so whatever closes those wakes us up again.
+        if (bulkChangeDepth.load() != 0 || pushingSnapshot.load() || !needsRedesign.exchange(false))
+            continue;
+
+        auto chainSettings = getChainSettings(apvts);
+
+        const juce::ScopedLock sl(snapshotLock);
+
+        if (chainSettings.snapshot != activeSnapshot)
+        {
+            switchSnapshot(chainSettings.snapshot);
+            continue;
+        }
+
+        auto& target = slots[static_cast<size_t>(writeIndex)];
+        design(target, chainSettings);
+
+        // keep the active slot in step with what's live, so switching away and back finds it as it was
+        snapshotValues[static_cast<size_t>(activeSnapshot)] = readParameterValues();
+        snapshotCoefficients[static_cast<size_t>(activeSnapshot)] = target;
+
+        publish();
+
+        if (onNewSettings != nullptr)
+            onNewSettings(chainSettings);
+    }
+}
+
+void CoefficientDesigner::switchSnapshot(int slot)
+{
+    // the parameters still hold everything of the slot we're leaving, apart from the Snapshot choice itself
+    snapshotValues[static_cast<size_t>(activeSnapshot)] = readParameterValues();
+    activeSnapshot = slot;
+
+    // the new slot was designed ahead, so the audio thread can start its crossfade right away
+    slots[static_cast<size_t>(writeIndex)] = snapshotCoefficients[static_cast<size_t>(slot)];
+    publish();
+
+    pushingSnapshot = true;
+    triggerAsyncUpdate();
+}
+
+void CoefficientDesigner::handleAsyncUpdate()
+{
+    juce::Array<float> values;
+
+    {
+        const juce::ScopedLock sl(snapshotLock);
+        values = snapshotValues[static_cast<size_t>(activeSnapshot)];
+    }
+
+    auto* snapshotParam = apvts.getParameter("Snapshot");
+    const auto& params = apvts.processor.getParameters();
+
+    // one bulk change, the resulting design matches the one already published
+    beginBulkChange();
+
+    for (int i = 0; i < juce::jmin(params.size(), values.size()); ++i)
+    {
+        auto* param = params[i];
+
+        if (param == snapshotParam)
+            continue;
+
+        auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(param);
+        const auto normalised = ranged != nullptr ? ranged->convertTo0to1(values[i]) : values[i];
+
+        if (normalised != param->getValue())
+            param->setValueNotifyingHost(normalised);
+    }
+
+    pushingSnapshot = false;
+    endBulkChange();
+}
+
+juce::Array<float> CoefficientDesigner::getSnapshotValues(int slot)
+{
+    const juce::ScopedLock sl(snapshotLock);
+
+    // the active slot is whatever the parameters say right now
+    if (slot == activeSnapshot)
+        return readParameterValues();
+
+    return snapshotValues[static_cast<size_t>(slot)];
+}
+
+void CoefficientDesigner::setSnapshotValues(int slot, const juce::Array<float>& values)
+{
+    const juce::ScopedLock sl(snapshotLock);
+
+    snapshotValues[static_cast<size_t>(slot)] = values;
+    designSnapshot(slot);
+}
+
+void CoefficientDesigner::setActiveSnapshot(int slot)
+{
+    const juce::ScopedLock sl(snapshotLock);
+    activeSnapshot = juce::jlimit(0, numSnapshots - 1, slot);
+}
+
+void CoefficientDesigner::designSnapshot(int slot)
+{
+    auto& coefficients = snapshotCoefficients[static_cast<size_t>(slot)];
+
+    auto chainSettings = getChainSettings(apvts, snapshotValues[static_cast<size_t>(slot)]);
+    chainSettings.snapshot = slot; // the stored Snapshot value is whatever was switched to when it was captured
+
+    design(coefficients, chainSettings);
+}
+
+juce::Array<float> CoefficientDesigner::readParameterValues() const
+{
+    juce::Array<float> values;
+
+    for (auto* param : apvts.processor.getParameters())
+    {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(param))
+            values.add(ranged->convertFrom0to1(ranged->getValue()));
+        else
+            values.add(param->getValue());
+    }
+
+    return values;
+}
+
+void CoefficientDesigner::publish()
+{
+    writeIndex = latest.exchange(writeIndex | newDataFlag, std::memory_order_acq_rel) & ~newDataFlag;
+}
+
+void CoefficientDesigner::design(ChainCoefficients& coefficients, const ChainSettings& chainSettings)
+{
+    designChainCoefficients(coefficients, chainSettings, hostSampleRate * (1 << chainSettings.oversampling));
+
+    coefficients.autoGainInDecibels = chainSettings.autoGain ? getAutoGain(coefficients) : 0.f;
+}
+
+float CoefficientDesigner::getAutoGain(const ChainCoefficients& coefficients)
+{
+    // Linked channels are the same curve, otherwise both count (for M/S that's mid and side, close enough)
+    const auto numChannels = coefficients.settings.stereoMode == StereoMode::StereoMode_Linked ? 1 : 2;
+
+    double power = 0;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto& curves = autoGainCurves[static_cast<size_t>(channel)];
+
+        curves.setFrequencies(numAutoGainPoints, coefficients.sampleRate);
+        curves.setChain(coefficients, channel);
+        curves.update();
+
+        // the points are log spaced, so a plain mean already is the pink weighted integral
+        for (auto magnitude : curves.getMagnitudes())
+            power += std::pow(10.0, magnitude / 10.0);
+    }
+
+    power /= numChannels * numAutoGainPoints;
+
+    // kept to +-24 dB, cutting nearly everything away shouldn't turn into a huge boost
+    return static_cast<float>(juce::jlimit(-24.0, 24.0, -10.0 * std::log10(juce::jmax(power, 1.0e-12))));
+}
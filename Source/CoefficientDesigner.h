@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    CoefficientDesigner.h
+
+    Designs the full coefficient set for both MonoChains and the extra bands
+    on a worker thread whenever a parameter changes. A change raises an
+    atomic flag, and the one that raises it posts the worker's semaphore,
+    which is fine from the audio thread too. Finished sets are handed to the audio
+    thread through a lock free triple buffer, so picking up new coefficients
+    at the start of a block is a single atomic exchange.
+
+    With auto gain on, each design also gets a level match: the mean of |H|^2
+    over a log spaced grid, which is the same as weighting it with pink noise
+    (equal power per octave). ResponseCurves keeps every stage's response, so
+    only what changed gets evaluated again, and the audio thread just folds
+    the result into the output gain ramp it already does.
+
+    It also keeps the snapshot slots. The parameters always hold the active
+    slot, the others are stored as plain values with a coefficient set that
+    is designed ahead of time, so a switch publishes straight away and the
+    parameters catch up on the message thread afterwards.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "ResponseCurves.h"
+#include "WakeSemaphore.h"
+
+class CoefficientDesigner : juce::Thread, juce::AudioProcessorValueTreeState::Listener, juce::AsyncUpdater
+{
+public:
+    CoefficientDesigner(juce::AudioProcessorValueTreeState& apvts);
+    ~CoefficientDesigner() override;
+
+    // Designs a first set on the calling thread and starts the worker if it isn't running yet.
+    // The snapshot slots only get designed again when the rate changed.
+    void prepare(double hostSampleRate);
+
+    // Audio thread only. The newest complete set if there is one it hasn't picked up yet, otherwise nullptr.
+    // The returned set stays valid until the next call.
+    const ChainCoefficients* getNewCoefficients();
+
+    // Forces a redesign even without a parameter change
+    void triggerRedesign();
+
+    // While a bulk change is open, parameter changes are only noted and nothing gets designed,
+    // so loading a whole state costs a single design when it's closed
+    void beginBulkChange();
+    void endBulkChange();
+
+    // Snapshot slots as plain parameter values in getParameters() order, for saving and loading state
+    juce::Array<float> getSnapshotValues(int slot);
+    void setSnapshotValues(int slot, const juce::Array<float>& values);
+
+    // Marks a slot as the one the parameters hold without switching to it, i.e. nothing gets stored or pushed
+    void setActiveSnapshot(int slot);
+
+    // Called on the worker with the settings of every live design, for whatever else has to follow them
+    // (the linear phase kernel). Set it before the first prepare.
+    std::function<void(const ChainSettings&)> onNewSettings;
+
+private:
+    void run() override;
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override; // pushes the slot we switched to into the parameters
+
+    void design(ChainCoefficients& coefficients, const ChainSettings& chainSettings);
+    float getAutoGain(const ChainCoefficients& coefficients);
+    void designSnapshot(int slot);
+    void switchSnapshot(int slot);
+    void publish();
+
+    juce::Array<float> readParameterValues() const;
+
+    juce::AudioProcessorValueTreeState& apvts;
+    juce::StringArray parameterIDs;
+
+    double hostSampleRate = 44100.0;
+    double snapshotSampleRate = 0; // what the snapshot slots were designed at
+
+    // one per channel, only ever used with snapshotLock held like the rest of the designing
+    static constexpr int numAutoGainPoints = 96; // about ten per octave
+    std::array<ResponseCurves, 2> autoGainCurves;
+
+    // Triple buffer: the worker owns writeIndex, the audio thread owns readIndex and the
+    // third slot sits in latest, with newDataFlag set when the worker has swapped a fresh one in
+    static constexpr int newDataFlag = 4;
+    std::array<ChainCoefficients, 3> slots;
+    int writeIndex = 0, readIndex = 1;
+    std::atomic<int> latest{ 2 };
+
+    // Sleeps on this between designs, no polling. Only a change that raises needsRedesign posts it,
+    // so a sweep of changes while a design runs still ends up as a single design after it.
+    WakeSemaphore wake;
+
+    std::atomic<bool> needsRedesign{ false };
+    std::atomic<int> bulkChangeDepth{ 0 };
+
+    // Everything snapshot related is shared between the worker and the message thread
+    juce::CriticalSection snapshotLock;
+    std::array<juce::Array<float>, numSnapshots> snapshotValues;
+    std::array<ChainCoefficients, numSnapshots> snapshotCoefficients;
+    int activeSnapshot = 0;
+
+    // set from a switch until the parameters have caught up, nothing live gets designed in between
+    std::atomic<bool> pushingSnapshot{ false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CoefficientDesigner)
+};
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    DialSpriteCache.cpp
+
+  ==============================================================================
+*/
+
+#include "DialSpriteCache.h"
+
+void DialSpriteCache::drawDial(juce::Graphics& g, juce::Point<float> centre, float radius, float angle, float thickness)
+{
+    const auto rx = centre.x - radius;
+    const auto ry = centre.y - radius;
+    const auto rw = radius * 2.0f;
+
+    // fill
+    g.setColour(juce::Colours::steelblue);
+    g.fillEllipse(rx, ry, rw, rw);
+
+    // outline
+    g.setColour(juce::Colours::lightsteelblue);
+    g.drawEllipse(rx, ry, rw, rw, thickness);
+
+    juce::Path p;
+    auto pointerLength = radius * 0.33f;
+    p.addRectangle(-thickness * 0.5f, -radius, thickness, pointerLength);
+    p.applyTransform(juce::AffineTransform::rotation(angle).translated(centre.x, centre.y));
+
+    // pointer
+    g.setColour(juce::Colours::lightsteelblue);
+    g.fillPath(p);
+}
+
+void DialSpriteCache::draw(juce::Graphics& g, juce::Point<float> centre, float radius,
+    float sliderPosProportional, float rotaryStartAngle, float rotaryEndAngle)
+{
+    if (radius <= 0)
+        return;
+
+    // one pixel of outline sticks out past the radius on each side
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const auto area = juce::Rectangle<float>(radius * 2.f + 2.f, radius * 2.f + 2.f).withCentre(centre);
+    const auto size = juce::roundToInt(area.getWidth() * scale);
+
+    const auto& sheet = getSheet(size, scale, rotaryStartAngle, rotaryEndAngle);
+    const auto frame = juce::jlimit(0, numFrames - 1, juce::roundToInt(sliderPosProportional * (numFrames - 1)));
+
+    g.drawImage(sheet.image,
+        juce::roundToInt(area.getX()), juce::roundToInt(area.getY()), juce::roundToInt(area.getWidth()), juce::roundToInt(area.getHeight()),
+        (frame % framesPerRow) * size, (frame / framesPerRow) * size, size, size);
+}
+
+const DialSpriteCache::Sheet& DialSpriteCache::getSheet(int size, float scale, float startAngle, float endAngle)
+{
+    for (auto& sheet : sheets)
+        if (sheet.size == size && sheet.scale == scale && sheet.startAngle == startAngle && sheet.endAngle == endAngle)
+            return sheet;
+
+    constexpr int numRows = (numFrames + framesPerRow - 1) / framesPerRow;
+    juce::Image image(juce::Image::ARGB, size * framesPerRow, size * numRows, true);
+
+    {
+        juce::Graphics g(image);
+
+        // drawn straight in physical pixels, so everything logical gets multiplied by the scale
+        const auto radius = (size - 2.f * scale) * 0.5f;
+
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            const auto angle = startAngle + frame / (float)(numFrames - 1) * (endAngle - startAngle);
+            const juce::Point<float> centre((frame % framesPerRow + 0.5f) * size, (frame / framesPerRow + 0.5f) * size);
+
+            drawDial(g, centre, radius, angle, 2.f * scale);
+        }
+    }
+
+    sheets.push_back({ size, scale, startAngle, endAngle, image });
+    return sheets.back();
+}
@@ -0,0 +1,43 @@
+/*
+  ==============================================================================
+
+    DialSpriteCache.h
+
+    Pre-rendered rotary dials. Every dial size (in physical pixels) gets one
+    sheet holding the dial at numFrames pointer positions, so painting a dial
+    is a single image blit instead of filling and stroking ellipses and paths.
+    Held through a SharedResourcePointer, so every open editor shares the same
+    sheets and only the first one pays for rendering them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class DialSpriteCache
+{
+public:
+    static constexpr int numFrames = 128;
+    static constexpr int framesPerRow = 16;
+
+    // Draws the dial centred in the area, at the frame closest to the slider position. Message thread only
+    void draw(juce::Graphics& g, juce::Point<float> centre, float radius,
+        float sliderPosProportional, float rotaryStartAngle, float rotaryEndAngle);
+
+    // The actual dial, used to fill the sheets
+    static void drawDial(juce::Graphics& g, juce::Point<float> centre, float radius, float angle, float thickness);
+
+private:
+    struct Sheet
+    {
+        int size;
+        float scale, startAngle, endAngle;
+        juce::Image image;
+    };
+
+    const Sheet& getSheet(int size, float scale, float startAngle, float endAngle);
+
+    std::vector<Sheet> sheets;
+};
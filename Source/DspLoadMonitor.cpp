@@ -0,0 +1,150 @@
+/*
+  ==============================================================================
+
+    DspLoadMonitor.cpp
+
+  ==============================================================================
+*/
+
+#include "DspLoadMonitor.h"
+
+const char* DspLoadMonitor::getStageName(int stage)
+{
+    switch (stage)
+    {
+    case Stage_Gain: return "Gain";
+    case Stage_Coefficients: return "Coefficients";
+    case Stage_LowCut: return "Low Cut";
+    case Stage_Peak: return "Peak";
+    case Stage_HighCut: return "High Cut";
+    case Stage_Bands: return "Bands";
+    case Stage_Limiter: return "Limiter";
+    case Stage_Parallel: return "Parallel";
+    case Stage_Total: return "Total";
+    default: return "";
+    }
+}
+
+void DspLoadMonitor::prepare(double sampleRate, int samplesPerBlock)
+{
+    budgetMicroseconds = sampleRate > 0 ? 1.0e6 * samplesPerBlock / sampleRate : 0.0;
+    blockTicks.fill(0);
+    resetRequested = true;
+}
+
+int DspLoadMonitor::getBin(double microseconds)
+{
+    if (microseconds <= 0.25)
+        return 0;
+
+    return juce::jlimit(0, numBins - 1, static_cast<int>(4.0 * (std::log2(microseconds) + 2.0)));
+}
+
+double DspLoadMonitor::getBinMicroseconds(int bin)
+{
+    return std::exp2((bin + 1) / 4.0 - 2.0); // top edge, so the p99 errs on the high side
+}
+
+void DspLoadMonitor::endBlock()
+{
+    if (resetRequested.exchange(false))
+    {
+        for (auto& accumulator : accumulators)
+        {
+            accumulator.totalTicks = 0;
+            accumulator.count = 0;
+            accumulator.maxTicks = 0;
+
+            for (auto& bin : accumulator.histogram)
+                bin = 0;
+        }
+    }
+
+    const auto ticksPerMicrosecond = juce::Time::getHighResolutionTicksPerSecond() / 1.0e6;
+
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        const auto ticks = blockTicks[stage];
+        auto& accumulator = accumulators[stage];
+
+        // only this thread ever writes, so plain load/store is enough
+        accumulator.totalTicks.store(accumulator.totalTicks.load(std::memory_order_relaxed) + (juce::uint64)ticks, std::memory_order_relaxed);
+        accumulator.count.store(accumulator.count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+        if (ticks > accumulator.maxTicks.load(std::memory_order_relaxed))
+            accumulator.maxTicks.store(ticks, std::memory_order_relaxed);
+
+        auto& bin = accumulator.histogram[static_cast<size_t>(getBin(ticks / ticksPerMicrosecond))];
+        bin.store(bin.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        blockTicks[stage] = 0;
+    }
+}
+
+DspLoadMonitor::Snapshot DspLoadMonitor::getSnapshot() const
+{
+    Snapshot snapshot;
+    snapshot.budgetMicroseconds = budgetMicroseconds.load();
+
+    const auto ticksPerMicrosecond = juce::Time::getHighResolutionTicksPerSecond() / 1.0e6;
+
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        const auto& accumulator = accumulators[stage];
+        auto& stats = snapshot.stages[static_cast<size_t>(stage)];
+
+        const auto count = accumulator.count.load(std::memory_order_acquire);
+
+        if (count == 0)
+            continue;
+
+        stats.meanMicroseconds = accumulator.totalTicks.load(std::memory_order_relaxed) / ticksPerMicrosecond / (double)count;
+        stats.maxMicroseconds = accumulator.maxTicks.load(std::memory_order_relaxed) / ticksPerMicrosecond;
+
+        // walk down from the top until 1% of the blocks are above us
+        juce::uint64 above = 0;
+        const auto threshold = count / 100;
+
+        for (int bin = numBins - 1; bin >= 0; --bin)
+        {
+            above += accumulator.histogram[static_cast<size_t>(bin)].load(std::memory_order_relaxed);
+
+            if (above > threshold)
+            {
+                stats.p99Microseconds = juce::jmin(getBinMicroseconds(bin), stats.maxMicroseconds);
+                break;
+            }
+        }
+
+        if (stage == Stage_Total)
+            snapshot.numBlocks = count;
+    }
+
+    return snapshot;
+}
+
+juce::String DspLoadMonitor::Snapshot::toJSON() const
+{
+    auto* root = new juce::DynamicObject();
+
+    root->setProperty("budgetMicroseconds", budgetMicroseconds);
+    root->setProperty("numBlocks", (juce::int64)numBlocks);
+    root->setProperty("loadPercent", getLoadPercent());
+    root->setProperty("peakLoadPercent", getPeakLoadPercent());
+
+    auto* stageObject = new juce::DynamicObject();
+
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        auto* stats = new juce::DynamicObject();
+        stats->setProperty("meanMicroseconds", stages[static_cast<size_t>(stage)].meanMicroseconds);
+        stats->setProperty("p99Microseconds", stages[static_cast<size_t>(stage)].p99Microseconds);
+        stats->setProperty("maxMicroseconds", stages[static_cast<size_t>(stage)].maxMicroseconds);
+
+        stageObject->setProperty(getStageName(stage), juce::var(stats));
+    }
+
+    root->setProperty("stages", juce::var(stageObject));
+
+    return juce::JSON::toString(juce::var(root));
+}
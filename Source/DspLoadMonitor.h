@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    DspLoadMonitor.h
+
+    Per instance timing of processBlock, split up into its stages. The audio
+    thread only adds up ticks and bumps a few atomics at the end of a block,
+    anything else (mean, p99, % of the real time budget) is worked out by
+    whoever asks for a snapshot.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class DspLoadMonitor
+{
+public:
+    enum Stage
+    {
+        Stage_Gain,
+        Stage_Coefficients,
+        Stage_LowCut,
+        Stage_Peak,
+        Stage_HighCut,
+        Stage_Bands,
+        Stage_Limiter,
+        Stage_Parallel, // the chains and bands together when the channels are split across the pool
+        Stage_Total, // the whole processBlock, so oversampling, convolution etc. show up here
+        numStages
+    };
+
+    static const char* getStageName(int stage);
+
+    struct StageStats
+    {
+        double meanMicroseconds = 0, p99Microseconds = 0, maxMicroseconds = 0;
+    };
+
+    struct Snapshot
+    {
+        std::array<StageStats, numStages> stages;
+        double budgetMicroseconds = 0; // length of a block in real time
+        juce::uint64 numBlocks = 0;
+
+        // share of the real time budget the whole block takes
+        double getLoadPercent() const { return budgetMicroseconds > 0 ? 100.0 * stages[Stage_Total].meanMicroseconds / budgetMicroseconds : 0; }
+        double getPeakLoadPercent() const { return budgetMicroseconds > 0 ? 100.0 * stages[Stage_Total].p99Microseconds / budgetMicroseconds : 0; }
+
+        juce::String toJSON() const;
+    };
+
+    // Times one stage for as long as it's in scope
+    struct ScopedStage
+    {
+        ScopedStage(DspLoadMonitor& monitorToUse, Stage stageToTime)
+            : monitor(monitorToUse), stage(stageToTime), start(juce::Time::getHighResolutionTicks()) {}
+
+        ~ScopedStage() { monitor.addStageTicks(stage, juce::Time::getHighResolutionTicks() - start); }
+
+        DspLoadMonitor& monitor;
+        Stage stage;
+        juce::int64 start;
+    };
+
+    void prepare(double sampleRate, int samplesPerBlock);
+
+    // Any thread, the audio thread does the actual clearing at its next block
+    void resetStatistics() { resetRequested = true; }
+
+    // Audio thread only
+    void addStageTicks(Stage stage, juce::int64 ticks) { blockTicks[stage] += ticks; }
+    void endBlock();
+
+    // Any thread
+    Snapshot getSnapshot() const;
+
+private:
+    // quarter octave bins from 1/4 us up, enough for the p99 without keeping every block around
+    static constexpr int numBins = 80;
+    static int getBin(double microseconds);
+    static double getBinMicroseconds(int bin);
+
+    struct StageAccumulator
+    {
+        std::atomic<juce::uint64> totalTicks{ 0 }, count{ 0 };
+        std::atomic<juce::int64> maxTicks{ 0 };
+        std::array<std::atomic<juce::uint32>, numBins> histogram{};
+    };
+
+    std::array<juce::int64, numStages> blockTicks{};
+    std::array<StageAccumulator, numStages> accumulators;
+
+    std::atomic<double> budgetMicroseconds{ 0 };
+    std::atomic<bool> resetRequested{ false };
+};
@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+    DynamicPeak.cpp
+
+  ==============================================================================
+*/
+
+#include "DynamicPeak.h"
+#include "PluginProcessor.h"
+
+void DynamicPeak::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+
+    detectorBuffer.assign(static_cast<size_t>(maximumBlockSize), 0.f);
+    gainOffsets.assign(static_cast<size_t>(maximumBlockSize / controlInterval + 1), 0.f);
+
+    // allocate the coefficients once here, after this they're only ever overwritten in place
+    detectorFilter.coefficients = new juce::dsp::IIR::Coefficients<float>(1, 0, 0, 1, 0, 0);
+    detectorFreq = 0;
+    detectorQuality = 0;
+
+    reset();
+}
+
+void DynamicPeak::reset()
+{
+    detectorFilter.reset();
+    envelopeInDecibels = -100.f;
+    std::fill(gainOffsets.begin(), gainOffsets.end(), 0.f);
+}
+
+void DynamicPeak::updateDetectorFilter(float frequency, float quality)
+{
+    if (frequency == detectorFreq && quality == detectorQuality)
+        return;
+
+    *detectorFilter.coefficients = juce::dsp::IIR::ArrayCoefficients<float>::makeBandPass(
+        sampleRate,
+        juce::jmin(frequency, static_cast<float>(sampleRate * 0.49)),
+        quality);
+
+    detectorFreq = frequency;
+    detectorQuality = quality;
+}
+
+void DynamicPeak::analyse(const juce::AudioBuffer<float>& detectorInput, const ChainSettings& chainSettings)
+{
+    const auto numSamples = juce::jmin(detectorInput.getNumSamples(), static_cast<int>(detectorBuffer.size()));
+    const auto numChannels = detectorInput.getNumChannels();
+
+    numControlSteps = (numSamples + controlInterval - 1) / controlInterval;
+
+    if (!chainSettings.peakDynamic || numChannels == 0 || numSamples == 0)
+    {
+        envelopeInDecibels = -100.f;
+        std::fill(gainOffsets.begin(), gainOffsets.begin() + numControlSteps, 0.f);
+        return;
+    }
+
+    // mono sum of whatever we're keying off
+    auto* detector = detectorBuffer.data();
+    juce::FloatVectorOperations::copy(detector, detectorInput.getReadPointer(0), numSamples);
+
+    for (int channel = 1; channel < numChannels; ++channel)
+        juce::FloatVectorOperations::add(detector, detectorInput.getReadPointer(channel), numSamples);
+
+    juce::FloatVectorOperations::multiply(detector, 1.f / numChannels, numSamples);
+
+    // only listen to the part of the spectrum the band actually touches
+    updateDetectorFilter(chainSettings.peakFreq, chainSettings.peakQuality);
+
+    float* channels[] = { detector };
+    juce::dsp::AudioBlock<float> detectorBlock(channels, 1, static_cast<size_t>(numSamples));
+    juce::dsp::ProcessContextReplacing<float> detectorContext(detectorBlock);
+    detectorFilter.process(detectorContext);
+
+    juce::FloatVectorOperations::abs(detector, detector, numSamples);
+
+    // envelope runs at the control rate, so the time constants are per interval rather than per sample
+    const auto intervalsPerSecond = sampleRate / controlInterval;
+    const auto attack = static_cast<float>(std::exp(-1000.0 / (chainSettings.peakAttackMs * intervalsPerSecond)));
+    const auto release = static_cast<float>(std::exp(-1000.0 / (chainSettings.peakReleaseMs * intervalsPerSecond)));
+    const auto slope = 1.f - 1.f / chainSettings.peakRatio;
+
+    for (int step = 0; step < numControlSteps; ++step)
+    {
+        const auto start = step * controlInterval;
+        const auto length = juce::jmin(controlInterval, numSamples - start);
+
+        const auto peak = juce::FloatVectorOperations::findMaximum(detector + start, length);
+        const auto levelInDecibels = juce::Decibels::gainToDecibels(peak, -100.f);
+
+        const auto coefficient = levelInDecibels > envelopeInDecibels ? attack : release;
+        envelopeInDecibels = levelInDecibels + coefficient * (envelopeInDecibels - levelInDecibels);
+
+        const auto over = envelopeInDecibels - chainSettings.peakThresholdInDecibels;
+        gainOffsets[static_cast<size_t>(step)] = over > 0.f ? -over * slope : 0.f;
+    }
+}
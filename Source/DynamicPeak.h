@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    DynamicPeak.h
+
+    Dynamic behaviour for the peak band. A band pass detector at the peak
+    frequency feeds a block based envelope follower and gain computer, which
+    hand back one gain offset per control interval. The processor redesigns
+    the peak coefficients once per interval instead of once per sample.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct ChainSettings;
+
+class DynamicPeak
+{
+public:
+    static constexpr int controlInterval = 32; // samples at the host rate between coefficient updates
+
+    void prepare(double sampleRate, int maximumBlockSize);
+    void reset();
+
+    // Runs the detector over the input (main or sidechain) and fills in the gain offsets for this block
+    void analyse(const juce::AudioBuffer<float>& detectorInput, const ChainSettings& chainSettings);
+
+    int getNumControlSteps() const { return numControlSteps; }
+
+    // dB to add to the static peak gain for the given control interval, always <= 0
+    float getGainOffset(int step) const { return gainOffsets[static_cast<size_t>(step)]; }
+
+private:
+    void updateDetectorFilter(float frequency, float quality);
+
+    double sampleRate = 44100.0;
+
+    juce::dsp::IIR::Filter<float> detectorFilter;
+    float detectorFreq = 0, detectorQuality = 0;
+
+    std::vector<float> detectorBuffer;
+    std::vector<float> gainOffsets;
+    int numControlSteps = 0;
+
+    float envelopeInDecibels = -100.f;
+};
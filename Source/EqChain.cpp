@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+    EqChain.cpp
+
+  ==============================================================================
+*/
+
+#include "EqChain.h"
+
+namespace
+{
+    using ArrayCoefficients = juce::dsp::IIR::ArrayCoefficients<float>;
+
+    // Same sections FilterDesign's Butterworth methods build (the slopes only give even orders),
+    // written straight into the array instead of a ReferenceCountedArray of new Coefficients
+    template<typename SectionDesign>
+    void designCut(std::array<ChainCoefficients::Biquad, 4>& sections, int slope, int& numRejected, SectionDesign&& designSection)
+    {
+        const auto order = 2 * (slope + 1);
+
+        for (int i = 0; i < order / 2; ++i)
+            sections[static_cast<size_t>(i)] = checkedBiquad(designSection(static_cast<float>(getButterworthQuality(order, i))), numRejected);
+    }
+}
+
+void ChainSet::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    // A fresh Filter only has first order storage, the first biquad assigned to it would allocate. These
+    // go in before prepare so its reset sizes the state for them now rather than at the first process.
+    for (auto* chain : { &leftChain, &rightChain })
+    {
+        for (auto* cut : { &chain->get<ChainPositions::LowCut>(), &chain->get<ChainPositions::HighCut>() })
+        {
+            updateCoefficients(cut->get<0>().coefficients, passThroughBiquad);
+            updateCoefficients(cut->get<1>().coefficients, passThroughBiquad);
+            updateCoefficients(cut->get<2>().coefficients, passThroughBiquad);
+            updateCoefficients(cut->get<3>().coefficients, passThroughBiquad);
+        }
+
+        updateCoefficients(chain->get<ChainPositions::Peak>().coefficients, passThroughBiquad);
+    }
+
+    leftChain.prepare(spec);
+    rightChain.prepare(spec);
+    bandChain.reset();
+}
+
+void /*SimpleEQAudioProcessor::*/ updateCoefficients(Coefficients& old, const Coefficients& replacements)
+{
+    *old = *replacements;
+}
+
+void updateCoefficients(Coefficients& old, const std::array<float, 6>& replacements)
+{
+    *old = replacements; // assigns in place, the storage is reused once it's been sized
+}
+
+Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::IIR::Coefficients<float>::makePeakFilter( // this is here to ensure that the setting changes are being applied in real time
+        sampleRate,
+        chainSettings.peakFreq,
+        chainSettings.peakQuality,
+        juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+}
+
+ChainSettings getChannelSettings(const ChainSettings& chainSettings, int channel)
+{
+    auto settings = chainSettings;
+
+    if (channel == 0 || chainSettings.stereoMode == StereoMode::StereoMode_Linked)
+        return settings;
+
+    settings.peakFreq = chainSettings.rightPeakFreq;
+    settings.peakGainInDecibels = chainSettings.rightPeakGainInDecibels;
+    settings.peakQuality = chainSettings.rightPeakQuality;
+    settings.lowCutFreq = chainSettings.rightLowCutFreq;
+    settings.highCutFreq = chainSettings.rightHighCutFreq;
+    settings.lowCutSlope = chainSettings.rightLowCutSlope;
+    settings.highCutSlope = chainSettings.rightHighCutSlope;
+
+    return settings;
+}
+
+void designChainCoefficients(ChainCoefficients& coefficients, const ChainSettings& chainSettings, double sampleRate)
+{
+    coefficients.settings = chainSettings;
+    coefficients.sampleRate = sampleRate;
+    coefficients.numRejectedSections = 0;
+
+    // nothing to design at yet (an editor before prepareToPlay), so everything stays flat
+    if (sampleRate <= 0)
+    {
+        for (auto& channelCoefficients : coefficients.channels)
+        {
+            channelCoefficients.lowCut.fill(passThroughBiquad);
+            channelCoefficients.highCut.fill(passThroughBiquad);
+            channelCoefficients.peak = passThroughBiquad;
+        }
+
+        coefficients.bands.setBands({}, sampleRate);
+        return;
+    }
+
+    // above Nyquist the designs fall apart, which only happens with the core running at a low rate
+    const auto maxFreq = static_cast<float>(sampleRate * 0.49);
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        const auto channelSettings = getChannelSettings(chainSettings, channel);
+        auto& channelCoefficients = coefficients.channels[static_cast<size_t>(channel)];
+
+        auto& numRejected = coefficients.numRejectedSections;
+
+        channelCoefficients.peak = checkedBiquad(ArrayCoefficients::makePeakFilter(sampleRate,
+            juce::jmin(channelSettings.peakFreq, maxFreq),
+            channelSettings.peakQuality,
+            juce::Decibels::decibelsToGain(channelSettings.peakGainInDecibels)), numRejected);
+
+        const auto lowCutFreq = juce::jmin(channelSettings.lowCutFreq, maxFreq);
+        designCut(channelCoefficients.lowCut, channelSettings.lowCutSlope, numRejected,
+            [&](float quality) { return ArrayCoefficients::makeHighPass(sampleRate, lowCutFreq, quality); });
+
+        const auto highCutFreq = juce::jmin(channelSettings.highCutFreq, maxFreq);
+        designCut(channelCoefficients.highCut, channelSettings.highCutSlope, numRejected,
+            [&](float quality) { return ArrayCoefficients::makeLowPass(sampleRate, highCutFreq, quality); });
+    }
+
+    coefficients.bands.setBands(chainSettings.bands, sampleRate);
+    coefficients.numRejectedSections += coefficients.bands.getNumRejectedBands();
+}
+
+void applyChainCoefficients(const ChainCoefficients& coefficients, ChainSet& chainSet)
+{
+    auto& leftChain = chainSet.leftChain;
+    auto& rightChain = chainSet.rightChain;
+
+    const auto rightSettings = getChannelSettings(coefficients.settings, 1);
+
+    const auto& left = coefficients.channels[0];
+    const auto& right = coefficients.channels[1];
+
+    updateCutFilter(leftChain.get<ChainPositions::LowCut>(), left.lowCut, static_cast<Slope>(coefficients.settings.lowCutSlope));
+    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, left.peak);
+    updateCutFilter(leftChain.get<ChainPositions::HighCut>(), left.highCut, static_cast<Slope>(coefficients.settings.highCutSlope));
+
+    updateCutFilter(rightChain.get<ChainPositions::LowCut>(), right.lowCut, static_cast<Slope>(rightSettings.lowCutSlope));
+    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, right.peak);
+    updateCutFilter(rightChain.get<ChainPositions::HighCut>(), right.highCut, static_cast<Slope>(rightSettings.highCutSlope));
+
+    chainSet.bandChain.copyCoefficientsFrom(coefficients.bands);
+}
+
+void encodeMidSide(float* left, float* right, int numSamples)
+{
+    // mid = (l + r) / 2 into the left channel, side = mid - r into the right one
+    juce::FloatVectorOperations::add(left, right, numSamples);
+    juce::FloatVectorOperations::multiply(left, 0.5f, numSamples);
+    juce::FloatVectorOperations::subtract(right, left, right, numSamples);
+}
+
+void decodeMidSide(float* mid, float* side, int numSamples)
+{
+    // left = mid + side, right = left - 2 * side
+    juce::FloatVectorOperations::add(mid, side, numSamples);
+    juce::FloatVectorOperations::multiply(side, -2.f, numSamples);
+    juce::FloatVectorOperations::add(side, mid, numSamples);
+}
@@ -0,0 +1,240 @@
+/*
+  ==============================================================================
+
+    EqChain.h
+
+    The filtering part of the EQ on its own: settings, the per channel chains
+    and the designers that fill them in. Only needs juce_dsp, nothing in here
+    knows about the processor, the APVTS or the GUI, so the plugin and the
+    standalone core library (see EqCore) share it as is.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BandChain.h"
+
+enum Slope // enums can be expressed as integers
+{
+    Slope_12,
+    Slope_24,
+    Slope_36,
+    Slope_48
+};
+
+enum OversamplingFactor
+{
+    Oversampling_Off,
+    Oversampling_2x,
+    Oversampling_4x,
+    Oversampling_8x
+};
+
+enum OversamplingFilter
+{
+    OversamplingFilter_IIR, // polyphase half-band IIR, minimum phase, low latency
+    OversamplingFilter_FIR  // equiripple half-band FIR, linear phase
+};
+
+enum StereoMode
+{
+    StereoMode_Linked,      // both channels share one set of coefficients
+    StereoMode_Independent, // left and right have their own settings
+    StereoMode_MidSide      // same as independent, but on mid and side
+};
+
+enum PhaseMode
+{
+    PhaseMode_Minimum, // the IIR chains
+    PhaseMode_Linear   // FIR kernel through FFT convolution, see LinearPhaseEQ
+};
+
+constexpr int numModulationTargets = 4; // LowCut Freq, HighCut Freq, Peak Freq, Peak Gain, see Modulation
+
+struct ChainSettings {
+    float peakFreq{ 0 }, peakGainInDecibels{ 0 }, peakQuality{ 1.f };
+    float lowCutFreq{ 0 }, highCutFreq{ 0 };
+    int lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
+    float outputGainInDB{ 0 };
+    int oversampling{ OversamplingFactor::Oversampling_Off }, oversamplingFilter{ OversamplingFilter::OversamplingFilter_IIR };
+    int phaseMode{ PhaseMode::PhaseMode_Minimum };
+    BandSettingsArray bands;
+
+    // dynamic behaviour of the peak band, see DynamicPeak
+    bool peakDynamic{ false }, peakSidechain{ false };
+    float peakThresholdInDecibels{ -20.f }, peakRatio{ 2.f }, peakAttackMs{ 10.f }, peakReleaseMs{ 100.f };
+
+    // second channel (right or side), only used outside of linked mode
+    int stereoMode{ StereoMode::StereoMode_Linked };
+    float rightPeakFreq{ 0 }, rightPeakGainInDecibels{ 0 }, rightPeakQuality{ 1.f };
+    float rightLowCutFreq{ 0 }, rightHighCutFreq{ 0 };
+    int rightLowCutSlope{ Slope::Slope_12 }, rightHighCutSlope{ Slope::Slope_12 };
+
+    int snapshot{ 0 }; // which settings slot these belong to
+
+    // output limiter, see OutputLimiter
+    bool limiterEnabled{ false };
+    float limiterCeilingInDecibels{ -1.f }, limiterLookaheadMs{ 1.5f }, limiterReleaseMs{ 100.f };
+
+    // level match from the designed response, see CoefficientDesigner
+    bool autoGain{ false };
+
+    // internal modulation, see Modulation
+    int modLfoRate{ 2 }, modLfoShape{ 0 }, modControlRate{ 1 };
+    float modEnvAttackMs{ 10.f }, modEnvReleaseMs{ 200.f };
+    std::array<int, numModulationTargets> modSource{};    // Modulation::Source per target
+    std::array<float, numModulationTargets> modDepth{};   // octaves for the frequencies, dB for the gain
+};
+
+using Filter = juce::dsp::IIR::Filter<float>;
+
+using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>; // each filter can be instantiated with a specified x*12 db slope, so you need 4 for the high and low cuts
+
+using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+
+enum ChainPositions
+{
+    LowCut,
+    Peak,
+    HighCut
+};
+
+// Everything that filters a block, one MonoChain per channel plus the extra bands.
+// The processor keeps two so it can crossfade between snapshots.
+struct ChainSet
+{
+    MonoChain leftChain, rightChain;
+    BandChain bandChain;
+
+    // Also gives every filter biquad sized coefficient storage, so copying a design in later never allocates
+    void prepare(const juce::dsp::ProcessSpec& spec);
+
+    void reset()
+    {
+        leftChain.reset();
+        rightChain.reset();
+        bandChain.reset();
+    }
+};
+
+// Putting here for editing response curve
+using Coefficients = Filter::CoefficientsPtr;
+void updateCoefficients(Coefficients& old, const Coefficients& replacements);
+void updateCoefficients(Coefficients& old, const std::array<float, 6>& replacements); // raw b0, b1, b2, a0, a1, a2
+
+Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+
+
+template<int Index, typename ChainType, typename CoefficientType>
+void update(ChainType& chain, const CoefficientType& coefficients)
+{
+    updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
+    chain.template setBypassed<Index>(false);
+}
+
+template<typename ChainType, typename CoefficientType>
+void updateCutFilter(ChainType& chain,
+    const CoefficientType& coefficients,
+    const Slope& slope)
+{
+    chain.template setBypassed<0>(true);
+    chain.template setBypassed<1>(true);
+    chain.template setBypassed<2>(true);
+    chain.template setBypassed<3>(true);
+
+    switch (slope)
+    {
+    case Slope_48:
+    {
+        update<3>(chain, coefficients);
+    }
+    case Slope_36:
+    {
+        update<2>(chain, coefficients);
+    }
+    case Slope_24:
+    {
+        update<1>(chain, coefficients);
+    }
+    case Slope_12:
+    {
+        update<0>(chain, coefficients);
+    }
+    }
+}
+
+
+inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(
+        chainSettings.lowCutFreq,
+        sampleRate,
+        2 * (chainSettings.lowCutSlope + 1));
+}
+
+inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(
+        chainSettings.highCutFreq,
+        sampleRate,
+        2 * (chainSettings.highCutSlope + 1));
+}
+
+// Settings as seen by one channel of the chain, for channel 1 outside of linked mode
+// the right/side values are moved into the regular fields so the make*Filter helpers just work
+ChainSettings getChannelSettings(const ChainSettings& chainSettings, int channel);
+
+// A whole chain set worth of designed coefficients, ready to be copied into the filters
+struct ChainCoefficients
+{
+    // Raw { b0, b1, b2, a0, a1, a2 } like ArrayCoefficients hands back, so they can be assigned in place
+    using Biquad = std::array<float, 6>;
+
+    struct Channel
+    {
+        std::array<Biquad, 4> lowCut{}, highCut{}; // only the first slope + 1 are valid
+        Biquad peak{};
+    };
+
+    ChainSettings settings;  // what this set was designed from
+    double sampleRate = 0;   // processing rate it was designed at
+    std::array<Channel, 2> channels;
+    BandChain bands;         // only its coefficients are used
+
+    // Sections (bands included) that came out unstable and run as pass throughs instead. Happens when
+    // float can't hold a very low frequency at a high processing rate, e.g. a 20 Hz cut at 8x of 48 kHz.
+    int numRejectedSections = 0;
+
+    float autoGainInDecibels = 0; // on top of the output gain, 0 unless settings.autoGain
+};
+
+// A section float can't hold (see isStableBiquad) runs as a pass through instead, and gets counted
+inline ChainCoefficients::Biquad checkedBiquad(const ChainCoefficients::Biquad& biquad, int& numRejected)
+{
+    if (!isStableBiquad(biquad))
+    {
+        ++numRejected;
+        return passThroughBiquad;
+    }
+
+    return biquad;
+}
+
+// Q of one second order section of an even order Butterworth cut, the same ones FilterDesign uses
+inline double getButterworthQuality(int order, int section)
+{
+    return 1.0 / (2.0 * std::cos((2.0 * section + 1.0) * juce::MathConstants<double>::pi / (order * 2.0)));
+}
+
+// Designs both channels at the given rate. Goes through ArrayCoefficients rather than the
+// make*Filter helpers, so it doesn't allocate and is fine to call from anywhere. A rate of 0 gives a flat set.
+void designChainCoefficients(ChainCoefficients& coefficients, const ChainSettings& chainSettings, double sampleRate);
+
+// Only copies into the existing coefficient objects, nothing gets designed or allocated here
+void applyChainCoefficients(const ChainCoefficients& coefficients, ChainSet& chainSet);
+
+// In place L/R <-> M/S
+void encodeMidSide(float* left, float* right, int numSamples);
+void decodeMidSide(float* mid, float* side, int numSamples);
@@ -0,0 +1,165 @@
+/*
+  ==============================================================================
+
+    EqCore.cpp
+
+  ==============================================================================
+*/
+
+#include "EqCore.h"
+
+EqCore::EqCore()
+{
+    coefficients.settings = getDefaultSettings();
+}
+
+ChainSettings EqCore::getDefaultSettings()
+{
+    ChainSettings settings;
+    settings.lowCutFreq = settings.rightLowCutFreq = 20.f;
+    settings.highCutFreq = settings.rightHighCutFreq = 20000.f;
+    settings.peakFreq = settings.rightPeakFreq = 750.f;
+
+    return settings;
+}
+
+void EqCore::prepare(double newSampleRate, int maximumBlockSize, int numChannels)
+{
+    jassert(newSampleRate > 0 && maximumBlockSize > 0);
+
+    sampleRate = newSampleRate;
+    maxBlockSize = juce::jmax(1, maximumBlockSize);
+
+    juce::dsp::ProcessSpec spec;
+    spec.sampleRate = sampleRate;
+    spec.maximumBlockSize = static_cast<juce::uint32>(maxBlockSize);
+    spec.numChannels = 1; // one MonoChain per channel
+
+    chainSet.prepare(spec);
+    deinterleaved.setSize(juce::jlimit(1, maxChannels, numChannels), maxBlockSize);
+
+    // redesign whatever was set before at the new rate, without a gain ramp on the first block
+    setSettings(coefficients.settings);
+    previousGain = gain;
+}
+
+void EqCore::reset()
+{
+    chainSet.reset();
+    previousGain = gain;
+}
+
+void EqCore::setSettings(const ChainSettings& chainSettings)
+{
+    designChainCoefficients(coefficients, chainSettings, sampleRate);
+    applyChainCoefficients(coefficients, chainSet);
+
+    gain = juce::Decibels::decibelsToGain(chainSettings.outputGainInDB);
+}
+
+void EqCore::processPlanar(float* const* channels, int numChannels, int numSamples)
+{
+    if (numChannels <= 0 || numSamples <= 0)
+        return;
+
+    // only refers to the caller's memory, up to 32 channels that doesn't allocate
+    juce::AudioBuffer<float> buffer(channels, juce::jmin(numChannels, maxChannels), numSamples);
+    process(buffer);
+}
+
+void EqCore::processInterleaved(float* samples, int numChannels, int numFrames)
+{
+    const auto numUsed = juce::jmin(numChannels, deinterleaved.getNumChannels());
+
+    if (numUsed <= 0)
+        return;
+
+    for (int start = 0; start < numFrames; start += maxBlockSize)
+    {
+        const auto numSamples = juce::jmin(maxBlockSize, numFrames - start);
+        auto* frames = samples + static_cast<size_t>(start) * static_cast<size_t>(numChannels);
+
+        for (int channel = 0; channel < numUsed; ++channel)
+        {
+            auto* destination = deinterleaved.getWritePointer(channel);
+
+            for (int i = 0; i < numSamples; ++i)
+                destination[i] = frames[i * numChannels + channel];
+        }
+
+        juce::AudioBuffer<float> buffer(deinterleaved.getArrayOfWritePointers(), numUsed, numSamples);
+        process(buffer);
+
+        for (int channel = 0; channel < numUsed; ++channel)
+        {
+            const auto* source = deinterleaved.getReadPointer(channel);
+
+            for (int i = 0; i < numSamples; ++i)
+                frames[i * numChannels + channel] = source[i];
+        }
+    }
+}
+
+void EqCore::process(juce::AudioBuffer<float>& buffer)
+{
+    // the caller's thread might not flush denormals, and a silent stream's filter tails would go subnormal
+    juce::ScopedNoDenormals noDenormals;
+
+    if (gain == previousGain)
+    {
+        buffer.applyGain(gain);
+    }
+    else
+    {
+        buffer.applyGainRamp(0, buffer.getNumSamples(), previousGain, gain);
+        previousGain = gain;
+    }
+
+    const bool midSide = coefficients.settings.stereoMode == StereoMode::StereoMode_MidSide && buffer.getNumChannels() > 1;
+
+    if (midSide)
+        encodeMidSide(buffer.getWritePointer(0), buffer.getWritePointer(1), buffer.getNumSamples());
+
+    juce::dsp::AudioBlock<float> block(buffer);
+
+    auto leftBlock = block.getSingleChannelBlock(0);
+    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
+    chainSet.leftChain.process(leftContext);
+
+    if (block.getNumChannels() > 1)
+    {
+        auto rightBlock = block.getSingleChannelBlock(1);
+        juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+        chainSet.rightChain.process(rightContext);
+    }
+
+    chainSet.bandChain.process(block);
+
+    if (midSide)
+        decodeMidSide(buffer.getWritePointer(0), buffer.getWritePointer(1), buffer.getNumSamples());
+}
+
+void EqCore::getResponse(const double* frequencies, double* magnitudesInDecibels, int numFrequencies, int channel) const
+{
+    const auto channelSettings = getChannelSettings(coefficients.settings, channel);
+    const auto& channelCoefficients = coefficients.channels[channel > 0 ? 1 : 0];
+
+    for (int i = 0; i < numFrequencies; ++i)
+    {
+        const auto zInverse = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequencies[i] / sampleRate);
+
+        auto power = static_cast<double>(gain) * gain;
+        power *= std::norm(evaluateBiquad(channelCoefficients.peak, zInverse));
+
+        for (int section = 0; section <= channelSettings.lowCutSlope; ++section)
+            power *= std::norm(evaluateBiquad(channelCoefficients.lowCut[static_cast<size_t>(section)], zInverse));
+
+        for (int section = 0; section <= channelSettings.highCutSlope; ++section)
+            power *= std::norm(evaluateBiquad(channelCoefficients.highCut[static_cast<size_t>(section)], zInverse));
+
+        for (int slot = 0; slot < coefficients.bands.getNumActiveBands(); ++slot)
+            power *= std::norm(evaluateBiquad(coefficients.bands.getBiquad(slot), zInverse));
+
+        magnitudesInDecibels[i] = 10.0 * std::log10(juce::jmax(power, 1.0e-30));
+    }
+}
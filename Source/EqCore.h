@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    EqCore.h
+
+    The minimum phase EQ without the plugin around it: low cut, peak, high cut,
+    the parametric bands, the stereo modes and the output gain, running the
+    same EqChain code the plugin does. Everything is sized in prepare, after
+    that setting, processing and querying never allocate or lock, so one of
+    these per stream is all a server side pipeline needs.
+
+    Not here: oversampling, linear phase, the dynamic peak, the modulation,
+    auto gain and the limiter, those only exist in the plugin. setSettings ignores the matching fields.
+
+    Not thread safe, settings changes and processing have to come from the
+    same thread (or be serialised by the caller). See KirbEqCore.h for the
+    C interface on top of it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "EqChain.h"
+
+class EqCore
+{
+public:
+    static constexpr int maxChannels = 2;
+
+    EqCore();
+
+    // The plugin's parameter defaults, i.e. flat
+    static ChainSettings getDefaultSettings();
+
+    // Everything that allocates happens here. Blocks longer than maximumBlockSize still work,
+    // they're only split up on the interleaved path.
+    void prepare(double sampleRate, int maximumBlockSize, int numChannels);
+
+    // Clears the filter state, keeps the settings
+    void reset();
+
+    // Designs and takes over the settings straight away, the gain ramps to its new value over the next block
+    void setSettings(const ChainSettings& chainSettings);
+    const ChainSettings& getSettings() const { return coefficients.settings; }
+
+    // numChannels can be less than prepared, anything past maxChannels is left alone
+    void processPlanar(float* const* channels, int numChannels, int numSamples);
+    void processInterleaved(float* samples, int numChannels, int numFrames);
+
+    // Magnitude of the whole chain in dB as channel 0 or 1 sees it, gain included
+    void getResponse(const double* frequencies, double* magnitudesInDecibels, int numFrequencies, int channel) const;
+
+    double getSampleRate() const { return sampleRate; }
+
+private:
+    void process(juce::AudioBuffer<float>& buffer);
+
+    double sampleRate = 44100.0;
+    int maxBlockSize = 0;
+
+    ChainCoefficients coefficients;
+    ChainSet chainSet;
+
+    float gain = 1.f, previousGain = 1.f;
+
+    juce::AudioBuffer<float> deinterleaved;
+};
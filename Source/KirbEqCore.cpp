@@ -0,0 +1,202 @@
+/*
+  ==============================================================================
+
+    KirbEqCore.cpp
+
+    The C functions from KirbEqCore.h, each one a thin wrapper around EqCore.
+
+  ==============================================================================
+*/
+
+#include "KirbEqCore.h"
+#include "EqCore.h"
+
+struct kirbeq
+{
+    EqCore core;
+    int numChannels = 0;
+};
+
+namespace
+{
+    ChainSettings toChainSettings(const kirbeq_settings& s)
+    {
+        auto settings = EqCore::getDefaultSettings();
+
+        settings.lowCutFreq = s.low_cut_freq;
+        settings.lowCutSlope = juce::jlimit(0, 3, s.low_cut_slope);
+        settings.highCutFreq = s.high_cut_freq;
+        settings.highCutSlope = juce::jlimit(0, 3, s.high_cut_slope);
+        settings.peakFreq = s.peak_freq;
+        settings.peakGainInDecibels = s.peak_gain_db;
+        settings.peakQuality = s.peak_quality;
+        settings.outputGainInDB = s.output_gain_db;
+        settings.stereoMode = juce::jlimit(0, 2, s.stereo_mode);
+
+        settings.rightLowCutFreq = s.right_low_cut_freq;
+        settings.rightLowCutSlope = juce::jlimit(0, 3, s.right_low_cut_slope);
+        settings.rightHighCutFreq = s.right_high_cut_freq;
+        settings.rightHighCutSlope = juce::jlimit(0, 3, s.right_high_cut_slope);
+        settings.rightPeakFreq = s.right_peak_freq;
+        settings.rightPeakGainInDecibels = s.right_peak_gain_db;
+        settings.rightPeakQuality = s.right_peak_quality;
+
+        for (int i = 0; i < KIRBEQ_NUM_BANDS; ++i)
+        {
+            auto& band = settings.bands[static_cast<size_t>(i)];
+            band.enabled = s.bands[i].enabled != 0;
+            band.type = juce::jlimit(0, 3, s.bands[i].type);
+            band.freq = s.bands[i].freq;
+            band.gainInDecibels = s.bands[i].gain_db;
+            band.quality = s.bands[i].quality;
+        }
+
+        return settings;
+    }
+
+    void fromChainSettings(const ChainSettings& settings, kirbeq_settings& s)
+    {
+        s.struct_size = sizeof(kirbeq_settings);
+
+        s.low_cut_freq = settings.lowCutFreq;
+        s.low_cut_slope = settings.lowCutSlope;
+        s.high_cut_freq = settings.highCutFreq;
+        s.high_cut_slope = settings.highCutSlope;
+        s.peak_freq = settings.peakFreq;
+        s.peak_gain_db = settings.peakGainInDecibels;
+        s.peak_quality = settings.peakQuality;
+        s.output_gain_db = settings.outputGainInDB;
+        s.stereo_mode = settings.stereoMode;
+
+        s.right_low_cut_freq = settings.rightLowCutFreq;
+        s.right_low_cut_slope = settings.rightLowCutSlope;
+        s.right_high_cut_freq = settings.rightHighCutFreq;
+        s.right_high_cut_slope = settings.rightHighCutSlope;
+        s.right_peak_freq = settings.rightPeakFreq;
+        s.right_peak_gain_db = settings.rightPeakGainInDecibels;
+        s.right_peak_quality = settings.rightPeakQuality;
+
+        for (int i = 0; i < KIRBEQ_NUM_BANDS; ++i)
+        {
+            const auto& band = settings.bands[static_cast<size_t>(i)];
+            s.bands[i].enabled = band.enabled ? 1 : 0;
+            s.bands[i].type = band.type;
+            s.bands[i].freq = band.freq;
+            s.bands[i].gain_db = band.gainInDecibels;
+            s.bands[i].quality = band.quality;
+        }
+    }
+
+    bool isValid(const kirbeq_settings& s)
+    {
+        auto positive = [](float value) { return std::isfinite(value) && value > 0.f; };
+
+        if (!positive(s.low_cut_freq) || !positive(s.high_cut_freq) || !positive(s.peak_freq) || !positive(s.peak_quality)
+            || !positive(s.right_low_cut_freq) || !positive(s.right_high_cut_freq) || !positive(s.right_peak_freq) || !positive(s.right_peak_quality)
+            || !std::isfinite(s.peak_gain_db) || !std::isfinite(s.right_peak_gain_db) || !std::isfinite(s.output_gain_db))
+            return false;
+
+        for (const auto& band : s.bands)
+            if (band.enabled && (!positive(band.freq) || !positive(band.quality) || !std::isfinite(band.gain_db)))
+                return false;
+
+        return true;
+    }
+
+    static_assert(numParametricBands == KIRBEQ_NUM_BANDS, "the C settings have to hold every band");
+    static_assert(EqCore::maxChannels == KIRBEQ_MAX_CHANNELS, "the C channel limit has to match the core");
+}
+
+const char* kirbeq_version(void)
+{
+    return "KirbEqCore 1.0";
+}
+
+void kirbeq_default_settings(kirbeq_settings* settings)
+{
+    if (settings != nullptr)
+        fromChainSettings(EqCore::getDefaultSettings(), *settings);
+}
+
+kirbeq* kirbeq_create(double sample_rate, int max_block_size, int num_channels)
+{
+    if (!(sample_rate > 0) || max_block_size <= 0 || num_channels <= 0 || num_channels > KIRBEQ_MAX_CHANNELS)
+        return nullptr;
+
+    auto* eq = new (std::nothrow) kirbeq();
+
+    if (eq != nullptr)
+    {
+        eq->numChannels = num_channels;
+        eq->core.prepare(sample_rate, max_block_size, num_channels);
+    }
+
+    return eq;
+}
+
+void kirbeq_destroy(kirbeq* eq)
+{
+    delete eq;
+}
+
+int kirbeq_set_settings(kirbeq* eq, const kirbeq_settings* settings)
+{
+    if (eq == nullptr || settings == nullptr || settings->struct_size == 0)
+        return KIRBEQ_INVALID_ARGUMENT;
+
+    // an older caller's struct is shorter, the fields it doesn't know about keep their defaults
+    kirbeq_settings known;
+    kirbeq_default_settings(&known);
+    std::memcpy(&known, settings, juce::jmin(static_cast<size_t>(settings->struct_size), sizeof(kirbeq_settings)));
+
+    if (!isValid(known))
+        return KIRBEQ_INVALID_ARGUMENT;
+
+    eq->core.setSettings(toChainSettings(known));
+    return KIRBEQ_OK;
+}
+
+int kirbeq_get_settings(const kirbeq* eq, kirbeq_settings* settings)
+{
+    if (eq == nullptr || settings == nullptr)
+        return KIRBEQ_INVALID_ARGUMENT;
+
+    fromChainSettings(eq->core.getSettings(), *settings);
+    return KIRBEQ_OK;
+}
+
+int kirbeq_reset(kirbeq* eq)
+{
+    if (eq == nullptr)
+        return KIRBEQ_INVALID_ARGUMENT;
+
+    eq->core.reset();
+    return KIRBEQ_OK;
+}
+
+int kirbeq_process_planar(kirbeq* eq, float* const* channels, int num_channels, int num_frames)
+{
+    if (eq == nullptr || channels == nullptr || num_channels <= 0 || num_frames < 0)
+        return KIRBEQ_INVALID_ARGUMENT;
+
+    eq->core.processPlanar(channels, juce::jmin(num_channels, eq->numChannels), num_frames);
+    return KIRBEQ_OK;
+}
+
+int kirbeq_process_interleaved(kirbeq* eq, float* samples, int num_channels, int num_frames)
+{
+    if (eq == nullptr || samples == nullptr || num_channels <= 0 || num_frames < 0)
+        return KIRBEQ_INVALID_ARGUMENT;
+
+    eq->core.processInterleaved(samples, num_channels, num_frames);
+    return KIRBEQ_OK;
+}
+
+int kirbeq_get_response(const kirbeq* eq, int channel, const double* frequencies, double* magnitudes_db, int num_frequencies)
+{
+    if (eq == nullptr || frequencies == nullptr || magnitudes_db == nullptr || num_frequencies < 0 || channel < 0 || channel >= KIRBEQ_MAX_CHANNELS)
+        return KIRBEQ_INVALID_ARGUMENT;
+
+    eq->core.getResponse(frequencies, magnitudes_db, num_frequencies, channel);
+    return KIRBEQ_OK;
+}
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    KirbEqCore.h
+
+    Plain C interface to EqCore, for running the EQ outside of a plugin host.
+    Nothing in here needs JUCE, a caller only includes this and links the
+    KirbEqCore library (Library/KirbEqCore.jucer).
+
+    kirbeq_create is the only call that allocates. Every other call is safe on
+    a real time thread, but a single instance must only be used from one
+    thread at a time. Separate instances don't share anything.
+
+    Functions returning int give KIRBEQ_OK or KIRBEQ_INVALID_ARGUMENT.
+
+  ==============================================================================
+*/
+
+#ifndef KIRBEQ_CORE_H
+#define KIRBEQ_CORE_H
+
+#ifndef KIRBEQ_API
+ #if defined (_WIN32) && defined (KIRBEQ_BUILDING_DLL)
+  #define KIRBEQ_API __declspec (dllexport)
+ #elif defined (_WIN32) && defined (KIRBEQ_DLL)
+  #define KIRBEQ_API __declspec (dllimport)
+ #elif defined (__GNUC__)
+  #define KIRBEQ_API __attribute__ ((visibility ("default")))
+ #else
+  #define KIRBEQ_API
+ #endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KIRBEQ_NUM_BANDS 24
+#define KIRBEQ_MAX_CHANNELS 2
+
+#define KIRBEQ_OK 0
+#define KIRBEQ_INVALID_ARGUMENT -1
+
+/* Slopes are 0...3 for 12, 24, 36 and 48 dB/oct */
+
+enum
+{
+    KIRBEQ_STEREO_LINKED = 0,       /* both channels use the left settings */
+    KIRBEQ_STEREO_INDEPENDENT = 1,  /* the right_* fields apply to channel 1 */
+    KIRBEQ_STEREO_MID_SIDE = 2      /* same, on mid and side */
+};
+
+enum
+{
+    KIRBEQ_BAND_PEAK = 0,
+    KIRBEQ_BAND_LOW_SHELF = 1,
+    KIRBEQ_BAND_HIGH_SHELF = 2,
+    KIRBEQ_BAND_NOTCH = 3
+};
+
+typedef struct kirbeq_band
+{
+    int enabled;
+    int type;
+    float freq;
+    float gain_db;
+    float quality;
+} kirbeq_band;
+
+/* Always start from kirbeq_default_settings, it fills in struct_size. Fields only
+   ever get added at the end, struct_size tells the library which ones a caller knows about. */
+typedef struct kirbeq_settings
+{
+    unsigned int struct_size;
+
+    float low_cut_freq;
+    int low_cut_slope;
+    float high_cut_freq;
+    int high_cut_slope;
+
+    float peak_freq;
+    float peak_gain_db;
+    float peak_quality;
+
+    float output_gain_db;
+    int stereo_mode;
+
+    float right_low_cut_freq;
+    int right_low_cut_slope;
+    float right_high_cut_freq;
+    int right_high_cut_slope;
+
+    float right_peak_freq;
+    float right_peak_gain_db;
+    float right_peak_quality;
+
+    kirbeq_band bands[KIRBEQ_NUM_BANDS];
+} kirbeq_settings;
+
+typedef struct kirbeq kirbeq;
+
+KIRBEQ_API const char* kirbeq_version (void);
+
+/* Flat, the same as a fresh plugin instance */
+KIRBEQ_API void kirbeq_default_settings (kirbeq_settings* settings);
+
+/* Up to KIRBEQ_MAX_CHANNELS channels. Returns NULL on bad arguments. */
+KIRBEQ_API kirbeq* kirbeq_create (double sample_rate, int max_block_size, int num_channels);
+KIRBEQ_API void kirbeq_destroy (kirbeq* eq);
+
+/* Takes effect on the next process call, the output gain ramps over that block */
+KIRBEQ_API int kirbeq_set_settings (kirbeq* eq, const kirbeq_settings* settings);
+KIRBEQ_API int kirbeq_get_settings (const kirbeq* eq, kirbeq_settings* settings);
+
+/* Clears the filter state, e.g. between unrelated streams */
+KIRBEQ_API int kirbeq_reset (kirbeq* eq);
+
+/* In place. Blocks of any length work, channels past KIRBEQ_MAX_CHANNELS are left untouched. */
+KIRBEQ_API int kirbeq_process_planar (kirbeq* eq, float* const* channels, int num_channels, int num_frames);
+KIRBEQ_API int kirbeq_process_interleaved (kirbeq* eq, float* samples, int num_channels, int num_frames);
+
+/* Magnitude response in dB of channel 0 or 1 at each of the given frequencies (Hz) */
+KIRBEQ_API int kirbeq_get_response (const kirbeq* eq, int channel, const double* frequencies,
+                                    double* magnitudes_db, int num_frequencies);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,203 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEQ.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseEQ.h"
+
+namespace
+{
+    // Only the fields that shape the response, output gain and the like shouldn't cost a redesign
+    bool sameChannelSettings(const ChainSettings& a, const ChainSettings& b)
+    {
+        return a.lowCutFreq == b.lowCutFreq && a.lowCutSlope == b.lowCutSlope
+            && a.highCutFreq == b.highCutFreq && a.highCutSlope == b.highCutSlope
+            && a.peakFreq == b.peakFreq && a.peakGainInDecibels == b.peakGainInDecibels
+            && a.peakQuality == b.peakQuality
+            && a.bands == b.bands;
+    }
+
+    bool sameFilterSettings(const ChainSettings& a, const ChainSettings& b)
+    {
+        return a.stereoMode == b.stereoMode
+            && sameChannelSettings(a, b)
+            && sameChannelSettings(getChannelSettings(a, 1), getChannelSettings(b, 1));
+    }
+}
+
+LinearPhaseEQ::LinearPhaseEQ(juce::AudioProcessorValueTreeState& apvtsToUse)
+    : juce::Thread("Linear Phase Kernel"), apvts(apvtsToUse)
+{
+}
+
+LinearPhaseEQ::~LinearPhaseEQ()
+{
+    stopThread(1000);
+}
+
+void LinearPhaseEQ::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    const juce::ScopedLock sl(threadLock);
+
+    stopThread(1000);
+
+    // Same rate means the same kernel size, and the convolution keeps its loaded kernel through prepare
+    const bool sameRate = spec.sampleRate == sampleRate;
+    sampleRate = spec.sampleRate;
+
+    if (!sameRate)
+    {
+        // Roughly 170 ms of kernel, enough resolution for the 20 Hz low cut
+        const int fftOrder = juce::jlimit(10, 16, (int)std::ceil(std::log2(sampleRate * 0.17)));
+        kernelSize = 1 << fftOrder;
+
+        fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+        fftBuffer.assign(static_cast<size_t>(kernelSize) * 2, 0.f);
+    }
+
+    convolution.prepare(spec);
+
+    // whatever was still queued is older than the parameters read here
+    {
+        const juce::ScopedLock pl(pendingLock);
+        hasPendingSettings = false;
+    }
+
+    const auto chainSettings = getChainSettings(apvts);
+
+    if (!sameRate || !hasKernel || !sameFilterSettings(chainSettings, lastSettings))
+    {
+        lastSettings = chainSettings;
+        rebuildKernel(lastSettings);
+        hasKernel = true;
+    }
+
+    startOrStopThread(chainSettings);
+}
+
+void LinearPhaseEQ::setSettings(const ChainSettings& chainSettings)
+{
+    {
+        const juce::ScopedLock sl(pendingLock);
+        pendingSettings = chainSettings;
+        hasPendingSettings = true;
+    }
+
+    const juce::ScopedLock sl(threadLock);
+    startOrStopThread(chainSettings);
+}
+
+void LinearPhaseEQ::startOrStopThread(const ChainSettings& chainSettings)
+{
+    // Nothing to keep up to date in the other modes, switching back hands over the latest settings anyway
+    if (chainSettings.phaseMode != PhaseMode::PhaseMode_Linear)
+    {
+        stopThread(1000);
+        return;
+    }
+
+    if (isThreadRunning())
+        notify();
+    else
+        startThread();
+}
+
+void LinearPhaseEQ::reset()
+{
+    convolution.reset();
+}
+
+void LinearPhaseEQ::process(juce::dsp::AudioBlock<float>& block)
+{
+    juce::dsp::ProcessContextReplacing<float> context(block);
+    convolution.process(context);
+}
+
+void LinearPhaseEQ::run()
+{
+    while (!threadShouldExit())
+    {
+        ChainSettings chainSettings;
+        bool hasNewSettings = false;
+
+        {
+            const juce::ScopedLock sl(pendingLock);
+            std::swap(hasNewSettings, hasPendingSettings);
+            chainSettings = pendingSettings;
+        }
+
+        // asleep until setSettings has something, several changes in between end up as one rebuild
+        if (!hasNewSettings)
+        {
+            wait(-1);
+            continue;
+        }
+
+        if (!hasKernel || !sameFilterSettings(chainSettings, lastSettings))
+        {
+            rebuildKernel(chainSettings);
+            lastSettings = chainSettings;
+            hasKernel = true;
+        }
+    }
+}
+
+void LinearPhaseEQ::rebuildKernel(const ChainSettings& chainSettings)
+{
+    // Linked gets away with one kernel for both channels, the other modes need one each
+    const bool linked = chainSettings.stereoMode == StereoMode::StereoMode_Linked;
+
+    juce::AudioBuffer<float> kernel(linked ? 1 : 2, kernelSize);
+
+    for (int channel = 0; channel < kernel.getNumChannels(); ++channel)
+        designKernel(getChannelSettings(chainSettings, channel), kernel.getWritePointer(channel));
+
+    // The convolution does the crossfade from the old kernel itself
+    convolution.loadImpulseResponse(std::move(kernel),
+        sampleRate,
+        linked ? juce::dsp::Convolution::Stereo::no : juce::dsp::Convolution::Stereo::yes,
+        juce::dsp::Convolution::Trim::no,
+        juce::dsp::Convolution::Normalise::no);
+}
+
+void LinearPhaseEQ::designKernel(const ChainSettings& chainSettings, float* kernelData)
+{
+    auto peak = makePeakFilter(chainSettings, sampleRate);
+    auto lowCut = makeLowCutFilter(chainSettings, sampleRate);
+    auto highCut = makeHighCutFilter(chainSettings, sampleRate);
+
+    bandChain.setBands(chainSettings.bands, sampleRate);
+
+    std::fill(fftBuffer.begin(), fftBuffer.end(), 0.f);
+
+    // Sample the minimum phase magnitude on the FFT bins and give it a pure delay of half the kernel,
+    // which is just a sign flip on every odd bin. The inverse transform is then symmetric around the middle.
+    for (int k = 0; k <= kernelSize / 2; ++k)
+    {
+        const double freq = k * sampleRate / kernelSize;
+        double mag = peak->getMagnitudeForFrequency(freq, sampleRate);
+
+        for (auto* coefficients : lowCut)
+            mag *= coefficients->getMagnitudeForFrequency(freq, sampleRate);
+
+        for (auto* coefficients : highCut)
+            mag *= coefficients->getMagnitudeForFrequency(freq, sampleRate);
+
+        mag *= bandChain.getMagnitudeForFrequency(freq, sampleRate);
+
+        fftBuffer[2 * k] = static_cast<float>((k & 1) ? -mag : mag);
+        fftBuffer[2 * k + 1] = 0.f;
+    }
+
+    fft->performRealOnlyInverseTransform(fftBuffer.data());
+
+    // Hann window centred on kernelSize / 2 so the kernel stays symmetric
+    for (int n = 0; n < kernelSize; ++n)
+    {
+        const auto window = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * n / kernelSize);
+        kernelData[n] = fftBuffer[n] * window;
+    }
+}
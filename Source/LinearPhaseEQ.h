@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEQ.h
+
+    Linear phase version of the EQ. The magnitude response of the low cut,
+    peak, high cut and extra bands is turned into a symmetric FIR kernel on a background
+    thread and run through partitioned FFT convolution.
+
+    The kernel thread only exists while linear phase is selected, and only
+    wakes up when the CoefficientDesigner hands over settings it has designed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+class LinearPhaseEQ : juce::Thread
+{
+public:
+    LinearPhaseEQ(juce::AudioProcessorValueTreeState& apvts);
+    ~LinearPhaseEQ() override;
+
+    // Stops the kernel thread, resizes everything for the new rate and designs a first kernel.
+    // Again at the same rate the kernel is only redesigned if the settings moved.
+    void prepare(const juce::dsp::ProcessSpec& spec);
+
+    // Any thread but the audio one, after the settings changed. Starts the kernel thread and queues
+    // a rebuild in linear phase mode, stops it in any other.
+    void setSettings(const ChainSettings& chainSettings);
+    void reset();
+
+    void process(juce::dsp::AudioBlock<float>& block);
+
+    // Half the kernel for the linear phase delay, plus whatever the convolution adds itself
+    int getLatencyInSamples() const { return kernelSize / 2 + convolution.getLatency(); }
+
+private:
+    void run() override;
+    void startOrStopThread(const ChainSettings& chainSettings);
+
+    void rebuildKernel(const ChainSettings& chainSettings);
+    void designKernel(const ChainSettings& chainSettings, float* kernelData);
+
+    juce::AudioProcessorValueTreeState& apvts;
+
+    // Non uniform partitions keep the head cheap while still handling long kernels
+    juce::dsp::Convolution convolution{ juce::dsp::Convolution::NonUniform{ 512 } };
+
+    double sampleRate = 0;
+    int kernelSize = 0;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<float> fftBuffer; // 2 * kernelSize, as performRealOnlyInverseTransform wants
+
+    BandChain bandChain; // only used for its coefficients
+
+    ChainSettings lastSettings; // what the current kernel was built from
+    bool hasKernel = false;
+
+    // settings waiting for the kernel thread
+    juce::CriticalSection pendingLock;
+    ChainSettings pendingSettings;
+    bool hasPendingSettings = false;
+
+    juce::CriticalSection threadLock; // prepare and setSettings both start and stop the thread
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LinearPhaseEQ)
+};
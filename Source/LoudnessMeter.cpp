@@ -0,0 +1,183 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.cpp
+
+  ==============================================================================
+*/
+
+#include "LoudnessMeter.h"
+
+void LoudnessMeter::prepare(double sampleRate, int newNumChannels)
+{
+    numChannels = newNumChannels;
+
+    // K-weighting at any rate, the analogue prototypes behind the 48 kHz coefficients in BS.1770
+    {
+        const double f0 = 1681.974450955533, gainInDecibels = 3.999843853973347, q = 0.7071752369554196;
+        const auto k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        const auto vh = std::pow(10.0, gainInDecibels / 20.0);
+        const auto vb = std::pow(vh, 0.4996667741545416);
+        const auto a0 = 1.0 + k / q + k * k;
+
+        shelf = { (vh + vb * k / q + k * k) / a0,
+                  2.0 * (k * k - vh) / a0,
+                  (vh - vb * k / q + k * k) / a0,
+                  2.0 * (k * k - 1.0) / a0,
+                  (1.0 - k / q + k * k) / a0 };
+    }
+
+    {
+        const double f0 = 38.13547087602444, q = 0.5003270373238773;
+        const auto k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        const auto a0 = 1.0 + k / q + k * k;
+
+        highPass = { 1.0, -2.0, 1.0,
+                     2.0 * (k * k - 1.0) / a0,
+                     (1.0 - k / q + k * k) / a0 };
+    }
+
+    states.assign(static_cast<size_t>(numChannels * 2), {});
+    stepLength = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+
+    for (int bin = 0; bin < numBins; ++bin)
+        binEnergies[static_cast<size_t>(bin)] = std::pow(10.0, (lowestLoudness + (bin + 0.5) * binWidth + 0.691) / 10.0);
+
+    truePeak.prepare(numChannels);
+
+    reset();
+}
+
+void LoudnessMeter::reset()
+{
+    std::fill(states.begin(), states.end(), State{});
+    stepPosition = 0;
+    stepEnergy = 0;
+    stepEnergies.fill(0);
+    stepIndex = 0;
+    numStepsFilled = 0;
+    histogram.fill(0);
+
+    truePeak.reset();
+    maxTruePeak = 0;
+
+    momentary = silence;
+    shortTerm = silence;
+    integrated = silence;
+    truePeakInDecibels = silence;
+}
+
+void LoudnessMeter::process(const juce::AudioBuffer<float>& buffer)
+{
+    if (resetRequested.exchange(false))
+        reset();
+
+    const auto channels = juce::jmin(numChannels, buffer.getNumChannels());
+    const auto numSamples = buffer.getNumSamples();
+
+    for (int start = 0; start < numSamples;)
+    {
+        // never run past the end of a 100 ms step
+        const auto length = juce::jmin(numSamples - start, stepLength - stepPosition);
+
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            const auto* samples = buffer.getReadPointer(channel, start);
+            auto& shelfState = states[static_cast<size_t>(channel * 2)];
+            auto& highPassState = states[static_cast<size_t>(channel * 2 + 1)];
+
+            double energy = 0;
+            float peak = 0;
+
+            for (int i = 0; i < length; ++i)
+            {
+                const double x = samples[i];
+
+                // both K-weighting stages, transposed direct form II
+                const auto y1 = shelf.b0 * x + shelfState.s1;
+                shelfState.s1 = shelf.b1 * x - shelf.a1 * y1 + shelfState.s2;
+                shelfState.s2 = shelf.b2 * x - shelf.a2 * y1;
+
+                const auto y2 = highPass.b0 * y1 + highPassState.s1;
+                highPassState.s1 = highPass.b1 * y1 - highPass.a1 * y2 + highPassState.s2;
+                highPassState.s2 = highPass.b2 * y1 - highPass.a2 * y2;
+
+                energy += y2 * y2;
+                peak = juce::jmax(peak, truePeak.processSample(channel, samples[i]));
+            }
+
+            stepEnergy += energy; // all channel weights are 1 for mono and stereo
+            maxTruePeak = juce::jmax(maxTruePeak, peak);
+        }
+
+        start += length;
+        stepPosition += length;
+
+        if (stepPosition >= stepLength)
+            finishStep();
+    }
+
+    truePeakInDecibels = juce::Decibels::gainToDecibels(maxTruePeak, silence);
+}
+
+void LoudnessMeter::finishStep()
+{
+    stepEnergies[static_cast<size_t>(stepIndex)] = stepEnergy / stepLength;
+    stepIndex = (stepIndex + 1) % numSteps;
+    numStepsFilled = juce::jmin(numStepsFilled + 1, numSteps);
+
+    stepEnergy = 0;
+    stepPosition = 0;
+
+    // mean of the newest 4 and the newest 30 steps
+    auto windowEnergy = [this](int steps)
+        {
+            double sum = 0;
+
+            for (int i = 1; i <= steps; ++i)
+                sum += stepEnergies[static_cast<size_t>((stepIndex - i + numSteps) % numSteps)];
+
+            return sum / steps;
+        };
+
+    if (numStepsFilled >= 4)
+    {
+        const auto blockEnergy = windowEnergy(4);
+        const auto blockLoudness = energyToLoudness(blockEnergy);
+
+        momentary = static_cast<float>(blockLoudness);
+
+        // every momentary block is also a gating block for the integrated loudness, 75% overlap
+        if (blockLoudness >= lowestLoudness)
+        {
+            const auto bin = juce::jmin(numBins - 1, static_cast<int>((blockLoudness - lowestLoudness) / binWidth));
+            ++histogram[static_cast<size_t>(bin)];
+            updateIntegrated();
+        }
+    }
+
+    shortTerm = static_cast<float>(energyToLoudness(windowEnergy(numStepsFilled)));
+}
+
+void LoudnessMeter::updateIntegrated()
+{
+    // absolute gate is already applied by what goes in the histogram, then the relative gate 10 LU under that
+    auto gatedLoudness = [this](int firstBin)
+        {
+            double energy = 0;
+            juce::uint64 count = 0;
+
+            for (int bin = firstBin; bin < numBins; ++bin)
+            {
+                energy += histogram[static_cast<size_t>(bin)] * binEnergies[static_cast<size_t>(bin)];
+                count += histogram[static_cast<size_t>(bin)];
+            }
+
+            return count > 0 ? energyToLoudness(energy / count) : static_cast<double>(silence);
+        };
+
+    const auto relativeGate = gatedLoudness(0) - 10.0;
+    const auto firstBin = juce::jlimit(0, numBins - 1, static_cast<int>(std::ceil((relativeGate - lowestLoudness) / binWidth)));
+
+    integrated = static_cast<float>(gatedLoudness(firstBin));
+}
@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.h
+
+    BS.1770 / EBU R128 metering of what leaves the plugin: momentary (400 ms),
+    short-term (3 s) and gated integrated loudness, plus the true peak.
+
+    The K-weighting, mean square and true peak all happen in the same pass
+    over the buffer. Loudness is updated every 100 ms, integrated loudness
+    comes out of a histogram of the 400 ms blocks (0.1 LU bins) so the gating
+    never has to keep the whole programme around. Results are published
+    through atomics for the editor to read.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TruePeakDetector.h"
+
+class LoudnessMeter
+{
+public:
+    static constexpr float silence = -100.f; // what the readings sit at before there's anything to measure
+
+    void prepare(double sampleRate, int numChannels);
+
+    // Audio thread
+    void process(const juce::AudioBuffer<float>& buffer);
+
+    // Any thread. Integrated loudness and the true peak hold until this is called
+    void requestReset() { resetRequested = true; }
+
+    float getMomentaryLoudness() const { return momentary.load(std::memory_order_relaxed); }
+    float getShortTermLoudness() const { return shortTerm.load(std::memory_order_relaxed); }
+    float getIntegratedLoudness() const { return integrated.load(std::memory_order_relaxed); }
+    float getTruePeakInDecibels() const { return truePeakInDecibels.load(std::memory_order_relaxed); }
+
+private:
+    void reset();
+    void finishStep();
+    void updateIntegrated();
+
+    static double energyToLoudness(double energy) { return energy > 0 ? -0.691 + 10.0 * std::log10(energy) : silence; }
+
+    struct Biquad { double b0, b1, b2, a1, a2; };
+    struct State { double s1 = 0, s2 = 0; };
+
+    Biquad shelf{}, highPass{}; // the two K-weighting stages
+    std::vector<State> states;  // two per channel
+    int numChannels = 0;
+
+    // 100 ms steps, the last 30 of them cover the short-term window
+    static constexpr int numSteps = 30;
+    int stepLength = 4800, stepPosition = 0;
+    double stepEnergy = 0;
+    std::array<double, numSteps> stepEnergies{};
+    int stepIndex = 0, numStepsFilled = 0;
+
+    // 400 ms blocks above the absolute gate, from -70 LUFS up in 0.1 LU bins
+    static constexpr int numBins = 1000;
+    static constexpr double lowestLoudness = -70.0, binWidth = 0.1;
+    std::array<juce::uint32, numBins> histogram{};
+    std::array<double, numBins> binEnergies{};
+
+    TruePeakDetector truePeak;
+    float maxTruePeak = 0;
+
+    std::atomic<float> momentary{ silence }, shortTerm{ silence }, integrated{ silence }, truePeakInDecibels{ silence };
+    std::atomic<bool> resetRequested{ false };
+};
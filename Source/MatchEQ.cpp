@@ -0,0 +1,388 @@
+/*
+  ==============================================================================
+
+    MatchEQ.cpp
+
+  ==============================================================================
+*/
+
+#include "MatchEQ.h"
+#include "ResponseEvaluator.h"
+
+namespace
+{
+    const double notMeasured = std::numeric_limits<double>::quiet_NaN();
+}
+
+MatchEQ::MatchEQ(juce::AudioProcessorValueTreeState& apvtsToUse)
+    : juce::Thread("Match EQ"),
+      apvts(apvtsToUse)
+{
+    formatManager.registerBasicFormats();
+
+    window.resize(fftSize);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), fftSize,
+        juce::dsp::WindowingFunction<float>::hann, false);
+
+    for (double freq = 20.0; freq <= 20000.0; freq *= std::pow(2.0, 1.0 / 12.0))
+        frequencies.push_back(freq);
+}
+
+MatchEQ::~MatchEQ()
+{
+    // the pool jobs see this and skip the rest of their frames, so run() gets to the end quickly
+    cancelled = true;
+    stopThread(10000);
+}
+
+bool MatchEQ::match(const juce::File& reference, const juce::File& target, double sampleRate, Callback onFinished)
+{
+    if (isThreadRunning())
+        return false;
+
+    referenceFile = reference;
+    targetFile = target;
+    fitSampleRate = sampleRate > 0 ? sampleRate : 44100.0;
+    callback = std::move(onFinished);
+
+    startThread();
+    return true;
+}
+
+void MatchEQ::run()
+{
+    auto finish = [this](bool succeeded, const juce::String& message, const ChainSettings& settings)
+        {
+            juce::MessageManager::callAsync([weakThis = juce::WeakReference<MatchEQ>(this), succeeded, message, settings]
+                {
+                    if (auto* self = weakThis.get())
+                    {
+                        if (succeeded)
+                            self->apply(settings);
+
+                        if (self->callback != nullptr)
+                            self->callback(succeeded, message);
+                    }
+                });
+        };
+
+    const auto reference = analyseFile(referenceFile);
+    const auto target = analyseFile(targetFile);
+
+    if (cancelled)
+        return;
+
+    if (reference.empty() || target.empty())
+    {
+        finish(false, "Couldn't read " + (reference.empty() ? referenceFile : targetFile).getFileName(), {});
+        return;
+    }
+
+    // what has to be added to the target to sound like the reference, with the overall level taken out
+    std::vector<double> correction(frequencies.size());
+    double sum = 0;
+    int numValid = 0;
+
+    for (size_t i = 0; i < frequencies.size(); ++i)
+    {
+        correction[i] = reference[i] - target[i]; // stays NaN above either file's Nyquist
+
+        if (!std::isnan(correction[i]))
+        {
+            sum += correction[i];
+            ++numValid;
+        }
+    }
+
+    if (numValid == 0)
+    {
+        finish(false, "Nothing to match", {});
+        return;
+    }
+
+    for (auto& value : correction)
+        if (!std::isnan(value))
+            value = juce::jlimit(-24.0, 24.0, value - sum / numValid);
+
+    finish(true, "Matched", fit(getChainSettings(apvts), correction, fitSampleRate));
+}
+
+juce::ThreadPool& MatchEQ::getPool()
+{
+    const juce::ScopedLock sl(poolLock);
+
+    if (pool == nullptr)
+        pool = std::make_unique<juce::ThreadPool>(juce::jmax(1, juce::SystemStats::getNumCpus()));
+
+    return *pool;
+}
+
+std::vector<double> MatchEQ::analyseFile(const juce::File& file)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+    if (reader == nullptr || reader->sampleRate <= 0)
+        return {};
+
+    const auto fileSampleRate = reader->sampleRate;
+    const auto length = reader->lengthInSamples;
+    const auto numFrames = length <= fftSize ? juce::int64(1) : (length - fftSize) / hopSize + 1;
+
+    constexpr int numBins = fftSize / 2 + 1;
+    std::vector<double> totalPower(numBins, 0.0);
+    juce::CriticalSection totalLock;
+
+    // a few segments per core so one slow disk read doesn't hold everything up
+    auto& jobPool = getPool();
+    const auto numJobs = static_cast<int>(juce::jmin<juce::int64>(numFrames, jobPool.getNumThreads() * 4));
+    std::atomic<int> jobsRemaining{ numJobs };
+    juce::WaitableEvent allDone;
+
+    for (int job = 0; job < numJobs; ++job)
+    {
+        const auto firstFrame = numFrames * job / numJobs;
+        const auto endFrame = numFrames * (job + 1) / numJobs;
+
+        jobPool.addJob([this, &file, &totalPower, &totalLock, &jobsRemaining, &allDone, firstFrame, endFrame]
+            {
+                // readers aren't thread safe, so every job streams through its own
+                std::unique_ptr<juce::AudioFormatReader> jobReader(formatManager.createReaderFor(file));
+
+                if (jobReader != nullptr)
+                {
+                    juce::dsp::FFT fft(fftOrder);
+                    juce::AudioBuffer<float> frame(juce::jmin(2, static_cast<int>(jobReader->numChannels)), fftSize);
+                    std::vector<float> fftData(2 * fftSize);
+                    std::vector<double> power(numBins, 0.0);
+
+                    for (auto index = firstFrame; index < endFrame && !cancelled; ++index)
+                    {
+                        jobReader->read(&frame, 0, fftSize, index * hopSize, true, frame.getNumChannels() > 1);
+
+                        // mono sum, windowed
+                        const auto* left = frame.getReadPointer(0);
+                        const auto* right = frame.getReadPointer(frame.getNumChannels() - 1);
+
+                        for (int i = 0; i < fftSize; ++i)
+                            fftData[static_cast<size_t>(i)] = 0.5f * (left[i] + right[i]) * window[static_cast<size_t>(i)];
+
+                        std::fill(fftData.begin() + fftSize, fftData.end(), 0.f);
+
+                        fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+                        for (int bin = 0; bin < numBins; ++bin)
+                            power[static_cast<size_t>(bin)] += (double)fftData[static_cast<size_t>(bin)] * fftData[static_cast<size_t>(bin)];
+                    }
+
+                    const juce::ScopedLock sl(totalLock);
+
+                    for (int bin = 0; bin < numBins; ++bin)
+                        totalPower[static_cast<size_t>(bin)] += power[static_cast<size_t>(bin)];
+                }
+
+                if (--jobsRemaining == 0)
+                    allDone.signal();
+            });
+    }
+
+    allDone.wait();
+
+    // average the bins that fall into each grid point's 1/12 octave, or the nearest one if the band is narrower
+    std::vector<double> levels(frequencies.size(), notMeasured);
+    const auto binWidth = fileSampleRate / fftSize;
+    const auto bandEdge = std::pow(2.0, 1.0 / 24.0);
+
+    for (size_t i = 0; i < frequencies.size(); ++i)
+    {
+        if (frequencies[i] > fileSampleRate * 0.45)
+            break;
+
+        const auto lowBin = juce::jlimit(1, numBins - 1, static_cast<int>(std::ceil(frequencies[i] / bandEdge / binWidth)));
+        const auto highBin = juce::jlimit(lowBin, numBins - 1, static_cast<int>(std::floor(frequencies[i] * bandEdge / binWidth)));
+
+        double power = 0;
+
+        for (int bin = lowBin; bin <= highBin; ++bin)
+            power += totalPower[static_cast<size_t>(bin)];
+
+        power /= (highBin - lowBin + 1) * (double)numFrames;
+
+        levels[i] = 10.0 * std::log10(power + 1.0e-20);
+    }
+
+    return levels;
+}
+
+ChainSettings MatchEQ::fit(const ChainSettings& start, const std::vector<double>& correction, double sampleRate)
+{
+    ResponseEvaluator evaluator;
+    evaluator.prepare(frequencies, sampleRate);
+
+    auto error = [&](const ChainSettings& settings)
+        {
+            evaluator.clear();
+            evaluator.addChain(settings);
+
+            double sum = 0;
+
+            for (size_t i = 0; i < correction.size(); ++i)
+            {
+                if (!std::isnan(correction[i]))
+                {
+                    const auto difference = evaluator.getDecibels(i) - correction[i];
+                    sum += difference * difference;
+                }
+            }
+
+            return sum;
+        };
+
+    // start from flat, keeping slopes, types and which bands are on
+    auto settings = start;
+    settings.lowCutFreq = 20.f;
+    settings.highCutFreq = 20000.f;
+    settings.peakGainInDecibels = 0.f;
+
+    for (auto& band : settings.bands)
+        band.gainInDecibels = 0.f;
+
+    // Rough start for the bell shapes: each one goes on whatever is furthest off at that point
+    auto placeOnLargestResidual = [&](float& freq, float& gainInDecibels)
+        {
+            evaluator.clear();
+            evaluator.addChain(settings);
+
+            size_t worst = 0;
+            double worstDifference = 0;
+
+            for (size_t i = 0; i < correction.size(); ++i)
+            {
+                const auto difference = std::isnan(correction[i]) ? 0.0 : correction[i] - evaluator.getDecibels(i);
+
+                if (std::abs(difference) > std::abs(worstDifference))
+                {
+                    worst = i;
+                    worstDifference = difference;
+                }
+            }
+
+            freq = static_cast<float>(frequencies[worst]);
+            gainInDecibels = static_cast<float>(juce::jlimit(-24.0, 24.0, worstDifference));
+        };
+
+    placeOnLargestResidual(settings.peakFreq, settings.peakGainInDecibels);
+
+    for (auto& band : settings.bands)
+        if (band.enabled && band.type == BandType::Band_Peak)
+            placeOnLargestResidual(band.freq, band.gainInDecibels);
+
+    // Each free value with its range. Frequencies and Q move in octaves, gains in dB
+    struct Dimension
+    {
+        float* value;
+        float minimum, maximum;
+        bool logarithmic;
+        float step;
+    };
+
+    std::vector<Dimension> dimensions;
+    dimensions.push_back({ &settings.lowCutFreq, 20.f, 20000.f, true, 1.f });
+    dimensions.push_back({ &settings.highCutFreq, 20.f, 20000.f, true, 1.f });
+    dimensions.push_back({ &settings.peakFreq, 20.f, 20000.f, true, 1.f });
+    dimensions.push_back({ &settings.peakGainInDecibels, -24.f, 24.f, false, 3.f });
+    dimensions.push_back({ &settings.peakQuality, 0.1f, 10.f, true, 0.5f });
+
+    for (auto& band : settings.bands)
+    {
+        if (!band.enabled)
+            continue;
+
+        dimensions.push_back({ &band.freq, 20.f, 20000.f, true, 1.f });
+
+        if (band.type != BandType::Band_Notch)
+            dimensions.push_back({ &band.gainInDecibels, -24.f, 24.f, false, 3.f });
+
+        dimensions.push_back({ &band.quality, 0.1f, 10.f, true, 0.5f });
+    }
+
+    // Coordinate descent: try a step either way on every value, halve the steps once nothing helps
+    auto bestError = error(settings);
+
+    for (int pass = 0; pass < 200 && !cancelled; ++pass)
+    {
+        bool improved = false;
+
+        for (auto& dimension : dimensions)
+        {
+            const auto original = *dimension.value;
+
+            for (auto direction : { 1.f, -1.f })
+            {
+                const auto candidate = dimension.logarithmic
+                    ? original * std::exp2(direction * dimension.step)
+                    : original + direction * dimension.step;
+
+                *dimension.value = juce::jlimit(dimension.minimum, dimension.maximum, candidate);
+
+                const auto candidateError = error(settings);
+
+                if (candidateError < bestError)
+                {
+                    bestError = candidateError;
+                    improved = true;
+                    break;
+                }
+
+                *dimension.value = original;
+            }
+        }
+
+        if (!improved)
+        {
+            bool converged = true;
+
+            for (auto& dimension : dimensions)
+            {
+                dimension.step *= 0.5f;
+                converged = converged && dimension.step < (dimension.logarithmic ? 1.f / 96.f : 0.05f);
+            }
+
+            if (converged)
+                break;
+        }
+    }
+
+    return settings;
+}
+
+void MatchEQ::apply(const ChainSettings& settings)
+{
+    auto set = [this](const juce::String& parameterID, float value)
+        {
+            if (auto* param = apvts.getParameter(parameterID))
+            {
+                param->beginChangeGesture();
+                param->setValueNotifyingHost(param->convertTo0to1(value));
+                param->endChangeGesture();
+            }
+        };
+
+    set("LowCut Freq", settings.lowCutFreq);
+    set("HighCut Freq", settings.highCutFreq);
+    set("Peak Freq", settings.peakFreq);
+    set("Peak Gain", settings.peakGainInDecibels);
+    set("Peak Quality", settings.peakQuality);
+
+    for (int i = 0; i < numParametricBands; ++i)
+    {
+        const auto& band = settings.bands[i];
+
+        if (!band.enabled)
+            continue;
+
+        const auto prefix = "Band " + juce::String(i + 1);
+        set(prefix + " Freq", band.freq);
+        set(prefix + " Gain", band.gainInDecibels);
+        set(prefix + " Quality", band.quality);
+    }
+}
@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    MatchEQ.h
+
+    Reference matching. The long term average spectrum of a reference file and
+    of the material to be matched are measured over the whole of each file, the
+    difference between them becomes the target curve, and the low cut, peak,
+    high cut and enabled bands are fitted to it.
+
+    Each file is split into segments that are read and FFT'd on a thread pool
+    (only started by the first analysis, most instances never match anything),
+    every job streaming through its own reader with one frame buffer, so long
+    files never have to be in memory. The fit evaluates candidate settings with
+    ResponseEvaluator on a fixed log spaced grid.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+class MatchEQ : juce::Thread
+{
+public:
+    MatchEQ(juce::AudioProcessorValueTreeState& apvts);
+    ~MatchEQ() override;
+
+    // Called on the message thread when a match has finished (or failed), after the parameters were set
+    using Callback = std::function<void(bool succeeded, const juce::String& message)>;
+
+    // Message thread. Returns false if a match is still running
+    bool match(const juce::File& reference, const juce::File& target, double sampleRate, Callback onFinished);
+
+    bool isBusy() const { return isThreadRunning(); }
+
+    juce::String getWildcard() const { return formatManager.getWildcardForAllFormats(); }
+
+    // Long term average level per grid frequency, NaN above the file's Nyquist. Blocks until done
+    std::vector<double> analyseFile(const juce::File& file);
+
+    // Settings closest to adding the correction (dB per grid frequency, NaN to skip) on top of flat
+    ChainSettings fit(const ChainSettings& start, const std::vector<double>& correction, double sampleRate);
+
+    const std::vector<double>& getFrequencies() const { return frequencies; }
+
+private:
+    void run() override;
+    void apply(const ChainSettings& settings);
+
+    juce::ThreadPool& getPool();
+
+    static constexpr int fftOrder = 13; // 8192 points, about 6 Hz bins at 48k
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 2;
+
+    juce::AudioProcessorValueTreeState& apvts;
+    juce::AudioFormatManager formatManager;
+    std::unique_ptr<juce::ThreadPool> pool;
+    juce::CriticalSection poolLock; // analyseFile can be called from outside run() too
+
+    std::vector<float> window;
+    std::vector<double> frequencies; // 1/12 octave from 20 Hz to 20 kHz
+
+    // the job run() is working on
+    juce::File referenceFile, targetFile;
+    double fitSampleRate = 44100.0;
+    Callback callback;
+
+    std::atomic<bool> cancelled{ false };
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(MatchEQ)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MatchEQ)
+};
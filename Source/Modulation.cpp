@@ -0,0 +1,226 @@
+/*
+  ==============================================================================
+
+    Modulation.cpp
+
+  ==============================================================================
+*/
+
+#include "Modulation.h"
+
+namespace
+{
+    // LFO cycle length in beats, one per Mod LFO Rate choice
+    constexpr std::array<double, 7> lfoBeats{ 0.25, 0.5, 1.0, 2.0, 4.0, 8.0, 16.0 };
+
+    float lfoValue(int shape, float phase)
+    {
+        switch (shape)
+        {
+        case Modulation::Shape_Triangle: return 1.f - 4.f * std::abs(phase - 0.5f);
+        case Modulation::Shape_Saw:      return 2.f * phase - 1.f;
+        case Modulation::Shape_Square:   return phase < 0.5f ? 1.f : -1.f;
+        default:                         return std::sin(juce::MathConstants<float>::twoPi * phase);
+        }
+    }
+}
+
+juce::String Modulation::getTargetName(int target)
+{
+    switch (target)
+    {
+    case Target_LowCutFreq:  return "LowCut Freq";
+    case Target_HighCutFreq: return "HighCut Freq";
+    case Target_PeakFreq:    return "Peak Freq";
+    case Target_PeakGain:    return "Peak Gain";
+    default:                 return {};
+    }
+}
+
+bool Modulation::isActive(const ChainSettings& chainSettings)
+{
+    for (int target = 0; target < numModulationTargets; ++target)
+        if (chainSettings.modSource[static_cast<size_t>(target)] != Source_Off && chainSettings.modDepth[static_cast<size_t>(target)] != 0.f)
+            return true;
+
+    return false;
+}
+
+void Modulation::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+
+    // the shortest interval sets how many steps a block can have
+    const auto maxSteps = static_cast<size_t>(maximumBlockSize / 16 + 1);
+
+    for (auto& targetOffsets : offsets)
+        targetOffsets.assign(maxSteps, 0.f);
+
+    warped.assign(maxSteps, 0.f);
+
+    for (auto& channelSteps : stepCoefficients)
+        channelSteps.assign(maxSteps, {});
+
+    reset();
+}
+
+void Modulation::reset()
+{
+    lfoPhase = 0;
+    envelope = 0;
+    numControlSteps = 0;
+    numRejectedSections = {};
+}
+
+void Modulation::analyse(const juce::AudioBuffer<float>& input, const ChainSettings& chainSettings, const Transport& transport)
+{
+    controlInterval = getControlInterval(chainSettings);
+
+    const auto numSamples = input.getNumSamples();
+    const auto numChannels = input.getNumChannels();
+
+    numControlSteps = juce::jmin((numSamples + controlInterval - 1) / controlInterval, static_cast<int>(warped.size()));
+    numRejectedSections = {};
+
+    // Synced to the host's position while it plays, free running at its tempo otherwise
+    const auto beats = lfoBeats[static_cast<size_t>(juce::jlimit(0, static_cast<int>(lfoBeats.size()) - 1, chainSettings.modLfoRate))];
+    const auto cyclesPerSample = transport.bpm / 60.0 / beats / sampleRate;
+
+    if (transport.isPlaying)
+    {
+        const auto cycles = transport.ppqPosition / beats;
+        lfoPhase = static_cast<float>(cycles - std::floor(cycles));
+    }
+
+    bool usesEnvelope = false;
+
+    for (auto source : chainSettings.modSource)
+        usesEnvelope = usesEnvelope || source == Source_Envelope;
+
+    // Only the value per interval gets used, so the follower runs at the control rate: one vectorised
+    // min/max per channel and interval for the peak, and the per sample coefficients raised to the
+    // interval's length
+    auto getCoefficient = [this](float milliseconds, int length)
+        {
+            return static_cast<float>(std::exp(-1000.0 * length / (juce::jmax(0.01f, milliseconds) * sampleRate)));
+        };
+
+    const auto attack = getCoefficient(chainSettings.modEnvAttackMs, controlInterval);
+    const auto release = getCoefficient(chainSettings.modEnvReleaseMs, controlInterval);
+
+    for (int step = 0; step < numControlSteps; ++step)
+    {
+        const auto start = step * controlInterval;
+        const auto length = juce::jmin(controlInterval, numSamples - start);
+
+        if (usesEnvelope && numChannels > 0)
+        {
+            float peak = 0;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const auto range = juce::FloatVectorOperations::findMinAndMax(input.getReadPointer(channel, start), length);
+                peak = juce::jmax(peak, -range.getStart(), range.getEnd());
+            }
+
+            // only the block's last interval can come up short
+            const auto coefficient = peak > envelope ? (length == controlInterval ? attack : getCoefficient(chainSettings.modEnvAttackMs, length))
+                                                     : (length == controlInterval ? release : getCoefficient(chainSettings.modEnvReleaseMs, length));
+            envelope = peak + coefficient * (envelope - peak);
+        }
+
+        // 0...1 over the bottom 60 dB
+        const auto envelopeValue = juce::jlimit(0.f, 1.f, (juce::Decibels::gainToDecibels(envelope, -60.f) + 60.f) / 60.f);
+        const auto lfo = lfoValue(chainSettings.modLfoShape, lfoPhase);
+
+        for (int target = 0; target < numModulationTargets; ++target)
+        {
+            const auto source = chainSettings.modSource[static_cast<size_t>(target)];
+            const auto value = source == Source_LFO ? lfo : source == Source_Envelope ? envelopeValue : 0.f;
+
+            offsets[static_cast<size_t>(target)][static_cast<size_t>(step)] = value * chainSettings.modDepth[static_cast<size_t>(target)];
+        }
+
+        lfoPhase += static_cast<float>(length * cyclesPerSample);
+        lfoPhase -= std::floor(lfoPhase);
+    }
+}
+
+template<typename SectionDesign>
+void Modulation::designCut(int channel, std::array<ChainCoefficients::Biquad, 4> ChainCoefficients::Channel::* cut, int slope, int& numRejected,
+    SectionDesign&& designSection)
+{
+    auto& steps = stepCoefficients[static_cast<size_t>(channel)];
+    const auto order = 2 * (slope + 1);
+
+    // section by section, each one a straight run over the steps with warped[] already filled in
+    for (int i = 0; i < order / 2; ++i)
+    {
+        const auto inverseQuality = static_cast<float>(1.0 / getButterworthQuality(order, i));
+        int numRejectedSteps = 0;
+
+        for (int step = 0; step < numControlSteps; ++step)
+            (steps[static_cast<size_t>(step)].*cut)[static_cast<size_t>(i)] = checkedBiquad(designSection(warped[static_cast<size_t>(step)], inverseQuality), numRejectedSteps);
+
+        numRejected += numRejectedSteps > 0 ? 1 : 0;
+    }
+}
+
+void Modulation::design(int channel, const ChainSettings& channelSettings, double processingSampleRate)
+{
+    auto& steps = stepCoefficients[static_cast<size_t>(channel)];
+    auto& numRejected = numRejectedSections[static_cast<size_t>(channel)];
+    numRejected = 0;
+
+    const auto maxFreq = static_cast<float>(processingSampleRate * 0.49);
+    const auto piOverRate = static_cast<float>(juce::MathConstants<double>::pi / processingSampleRate);
+
+    auto frequency = [maxFreq](float base, float octaves) { return juce::jlimit(20.f, maxFreq, base * std::exp2(octaves)); };
+
+    const auto& lowCutOffsets = offsets[Target_LowCutFreq];
+    const auto& highCutOffsets = offsets[Target_HighCutFreq];
+    const auto& peakFreqOffsets = offsets[Target_PeakFreq];
+    const auto& peakGainOffsets = offsets[Target_PeakGain];
+
+    // Same formulas as ArrayCoefficients::makeHighPass, with the tan shared between the sections
+    for (int step = 0; step < numControlSteps; ++step)
+        warped[static_cast<size_t>(step)] = std::tan(piOverRate * frequency(channelSettings.lowCutFreq, lowCutOffsets[static_cast<size_t>(step)]));
+
+    designCut(channel, &ChainCoefficients::Channel::lowCut, channelSettings.lowCutSlope, numRejected, [](float n, float inverseQuality)
+        {
+            const auto nSquared = n * n;
+            const auto c1 = 1.f / (1.f + n * inverseQuality + nSquared);
+
+            return ChainCoefficients::Biquad{ c1, -2.f * c1, c1, 1.f, c1 * 2.f * (nSquared - 1.f), c1 * (1.f - n * inverseQuality + nSquared) };
+        });
+
+    // and makeLowPass, which works from the reciprocal
+    for (int step = 0; step < numControlSteps; ++step)
+        warped[static_cast<size_t>(step)] = 1.f / std::tan(piOverRate * frequency(channelSettings.highCutFreq, highCutOffsets[static_cast<size_t>(step)]));
+
+    designCut(channel, &ChainCoefficients::Channel::highCut, channelSettings.highCutSlope, numRejected, [](float n, float inverseQuality)
+        {
+            const auto nSquared = n * n;
+            const auto c1 = 1.f / (1.f + n * inverseQuality + nSquared);
+
+            return ChainCoefficients::Biquad{ c1, 2.f * c1, c1, 1.f, c1 * 2.f * (1.f - nSquared), c1 * (1.f - n * inverseQuality + nSquared) };
+        });
+
+    // and makePeakFilter, a0 isn't normalised here either, assigning to the filter's coefficients does that
+    const auto quality = channelSettings.peakQuality;
+    int numRejectedSteps = 0;
+
+    for (int step = 0; step < numControlSteps; ++step)
+    {
+        const auto omega = 2.f * piOverRate * frequency(channelSettings.peakFreq, peakFreqOffsets[static_cast<size_t>(step)]);
+        const auto gainInDecibels = juce::jmax(channelSettings.peakGainInDecibels + peakGainOffsets[static_cast<size_t>(step)], -48.f);
+
+        const auto A = std::pow(10.f, gainInDecibels / 40.f); // sqrt of the linear gain
+        const auto alpha = std::sin(omega) / (2.f * quality);
+        const auto c2 = -2.f * std::cos(omega);
+
+        steps[static_cast<size_t>(step)].peak = checkedBiquad({ 1.f + alpha * A, c2, 1.f - alpha * A, 1.f + alpha / A, c2, 1.f - alpha / A }, numRejectedSteps);
+    }
+
+    numRejected += numRejectedSteps > 0 ? 1 : 0;
+}
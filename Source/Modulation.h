@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    Modulation.h
+
+    Built in modulation of the low cut, high cut and peak frequencies and the
+    peak gain, from a tempo synced LFO or an envelope follower on the input.
+    Like DynamicPeak it works per control interval: analyse hands back one
+    offset per target and interval, design turns those into coefficients for
+    every interval of the block at once (one pass over the intervals per
+    section, the tan/sin/cos once per interval and filter rather than once per
+    section), and the processor copies them in between sub-blocks. None of it
+    goes through the parameters or the coefficient designer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "EqChain.h"
+
+class Modulation
+{
+public:
+    enum Source
+    {
+        Source_Off,
+        Source_LFO,
+        Source_Envelope
+    };
+
+    enum Target
+    {
+        Target_LowCutFreq,  // depth in octaves
+        Target_HighCutFreq, // depth in octaves
+        Target_PeakFreq,    // depth in octaves
+        Target_PeakGain     // depth in dB
+    };
+
+    enum Shape
+    {
+        Shape_Sine,
+        Shape_Triangle,
+        Shape_Saw,
+        Shape_Square
+    };
+
+    // Parameter that's being modulated, its own parameters are "<name> Mod Source" and "<name> Mod Depth"
+    static juce::String getTargetName(int target);
+
+    // Samples at the host rate between coefficient updates, from the Mod Control Rate choice
+    static int getControlInterval(const ChainSettings& chainSettings) { return 16 << juce::jlimit(0, 3, chainSettings.modControlRate); }
+
+    // Anything with a source and a depth
+    static bool isActive(const ChainSettings& chainSettings);
+
+    struct Transport
+    {
+        double bpm = 120.0;
+        double ppqPosition = 0.0;
+        bool isPlaying = false; // otherwise the LFO free runs at bpm
+    };
+
+    void prepare(double sampleRate, int maximumBlockSize);
+    void reset();
+
+    // Moves the LFO and the envelope (from the input) along by a block and works out every target's offset per interval
+    void analyse(const juce::AudioBuffer<float>& input, const ChainSettings& chainSettings, const Transport& transport);
+
+    int getNumControlSteps() const { return numControlSteps; }
+    int getCurrentControlInterval() const { return controlInterval; }
+
+    // dB on top of the peak gain target, for folding the dynamic peak in
+    void addPeakGainOffset(int step, float decibels) { offsets[Target_PeakGain][static_cast<size_t>(step)] += decibels; }
+
+    // Cut and peak coefficients of one channel for every interval of the block, doesn't allocate
+    void design(int channel, const ChainSettings& channelSettings, double processingSampleRate);
+
+    // Sections that ran as pass throughs for at least one interval of the block (see checkedBiquad),
+    // over the channels designed since the last analyse
+    int getNumRejectedSections() const { return numRejectedSections[0] + numRejectedSections[1]; }
+
+    const ChainCoefficients::Channel& getStepCoefficients(int channel, int step) const
+    {
+        return stepCoefficients[static_cast<size_t>(channel)][static_cast<size_t>(step)];
+    }
+
+private:
+    template<typename SectionDesign>
+    void designCut(int channel, std::array<ChainCoefficients::Biquad, 4> ChainCoefficients::Channel::* cut, int slope, int& numRejected,
+        SectionDesign&& designSection);
+
+    double sampleRate = 44100.0;
+
+    float lfoPhase = 0; // 0...1
+    float envelope = 0;
+
+    int controlInterval = 32, numControlSteps = 0;
+
+    std::array<std::vector<float>, numModulationTargets> offsets;
+    std::vector<float> warped; // scratch, one per step
+    std::array<std::vector<ChainCoefficients::Channel>, 2> stepCoefficients;
+    std::array<int, 2> numRejectedSections{};
+};
@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+    OutputLimiter.cpp
+
+  ==============================================================================
+*/
+
+#include "OutputLimiter.h"
+
+void OutputLimiter::prepare(double newSampleRate, int newNumChannels, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+    numChannels = newNumChannels;
+    maxBlockSize = juce::jmax(1, maximumBlockSize);
+
+    maxLookahead = juce::jmax(TruePeakDetector::latencyInSamples + 1,
+        static_cast<int>(std::ceil(sampleRate * maxLookaheadMs / 1000.0)));
+
+    truePeak.prepare(numChannels);
+
+    delay.assign(static_cast<size_t>(numChannels * (maxLookahead + 1)), 0.f);
+    minimumValues.assign(static_cast<size_t>(maxLookahead), 1.f);
+    minimumTimes.assign(static_cast<size_t>(maxLookahead), 0u);
+    averageHistory.assign(static_cast<size_t>(maxLookahead), 1.f);
+
+    peaks.assign(static_cast<size_t>(maxBlockSize), 0.f);
+    gains.assign(static_cast<size_t>(maxBlockSize), 1.f);
+
+    lookahead = 0; // forces the first setParameters through
+    setParameters(-1.f, 1.5f, 100.f);
+}
+
+void OutputLimiter::reset()
+{
+    truePeak.reset();
+
+    std::fill(delay.begin(), delay.end(), 0.f);
+    delayPosition = 0;
+
+    minimumHead = 0;
+    minimumSize = 0;
+    time = 0;
+
+    std::fill(averageHistory.begin(), averageHistory.end(), 1.f);
+    averagePosition = 0;
+    averageSum = window;
+
+    envelope = 1.f;
+    gainReductionInDecibels = 0.f;
+}
+
+void OutputLimiter::setParameters(float ceilingInDecibels, float lookaheadMs, float releaseMs)
+{
+    ceiling = juce::Decibels::decibelsToGain(ceilingInDecibels);
+    releaseCoefficient = static_cast<float>(std::exp(-1.0 / (sampleRate * releaseMs / 1000.0)));
+
+    // the detector already looks back latencyInSamples, the rest of the delay is the ramp
+    const auto newLookahead = juce::jlimit(TruePeakDetector::latencyInSamples + 1, maxLookahead,
+        juce::roundToInt(sampleRate * lookaheadMs / 1000.0));
+
+    if (newLookahead != lookahead)
+    {
+        lookahead = newLookahead;
+        window = lookahead - TruePeakDetector::latencyInSamples + 1;
+        window = juce::jlimit(1, maxLookahead, window);
+        reset();
+    }
+}
+
+void OutputLimiter::process(juce::AudioBuffer<float>& buffer)
+{
+    const auto numSamples = buffer.getNumSamples();
+    float lowestGain = 1.f;
+
+    for (int start = 0; start < numSamples; start += maxBlockSize)
+    {
+        const auto length = juce::jmin(maxBlockSize, numSamples - start);
+        processChunk(buffer, start, length);
+
+        lowestGain = juce::jmin(lowestGain, juce::FloatVectorOperations::findMinimum(gains.data(), length));
+    }
+
+    gainReductionInDecibels = juce::Decibels::gainToDecibels(lowestGain);
+}
+
+void OutputLimiter::processChunk(juce::AudioBuffer<float>& buffer, int start, int length)
+{
+    const auto channels = juce::jmin(numChannels, buffer.getNumChannels());
+
+    // 1. loudest true peak across the channels for every sample
+    juce::FloatVectorOperations::clear(peaks.data(), length);
+
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        const auto* samples = buffer.getReadPointer(channel, start);
+
+        for (int i = 0; i < length; ++i)
+            peaks[static_cast<size_t>(i)] = juce::jmax(peaks[static_cast<size_t>(i)], truePeak.processSample(channel, samples[i]));
+    }
+
+    // 2. gain computer: required gain -> sliding minimum -> release -> moving average. The required gain
+    // and the average's scaling are vector passes over the chunk, only the recursive parts (the queue,
+    // the release and the running sum) go sample by sample in between.
+    auto* gainData = gains.data();
+
+    // ceiling / max(peak, ceiling), i.e. 1 under the ceiling. FloatVectorOperations has no divide, the
+    // loop is branch free so the compiler vectorises it.
+    juce::FloatVectorOperations::max(gainData, peaks.data(), ceiling, length);
+
+    for (int i = 0; i < length; ++i)
+        gainData[i] = ceiling / gainData[i];
+
+    const auto capacity = static_cast<int>(minimumValues.size());
+
+    for (int i = 0; i < length; ++i, ++time)
+    {
+        const auto required = gainData[i];
+
+        // drop anything from the back that the new value undercuts, then whatever fell out of the window
+        while (minimumSize > 0 && minimumValues[static_cast<size_t>((minimumHead + minimumSize - 1) % capacity)] >= required)
+            --minimumSize;
+
+        const auto back = (minimumHead + minimumSize) % capacity;
+        minimumValues[static_cast<size_t>(back)] = required;
+        minimumTimes[static_cast<size_t>(back)] = time;
+        ++minimumSize;
+
+        if (time - minimumTimes[static_cast<size_t>(minimumHead)] >= static_cast<juce::uint32>(window))
+        {
+            minimumHead = (minimumHead + 1) % capacity;
+            --minimumSize;
+        }
+
+        const auto held = minimumValues[static_cast<size_t>(minimumHead)];
+
+        // straight down (the average does the ramp), back up with the release
+        envelope = held < envelope ? held : held + (envelope - held) * releaseCoefficient;
+
+        averageSum += envelope - averageHistory[static_cast<size_t>(averagePosition)];
+        averageHistory[static_cast<size_t>(averagePosition)] = envelope;
+        averagePosition = averagePosition + 1 == window ? 0 : averagePosition + 1;
+
+        gainData[i] = static_cast<float>(averageSum);
+    }
+
+    // the running sums into the average, never above unity
+    juce::FloatVectorOperations::multiply(gainData, 1.f / static_cast<float>(window), length);
+    juce::FloatVectorOperations::min(gainData, gainData, 1.f, length);
+
+    // 3. delay the audio by the lookahead and apply the gain
+    const auto delayLength = maxLookahead + 1;
+    auto position = delayPosition;
+
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        auto* samples = buffer.getWritePointer(channel, start);
+        auto* line = delay.data() + channel * delayLength;
+
+        position = delayPosition;
+
+        for (int i = 0; i < length; ++i)
+        {
+            const auto readPosition = (position - lookahead + delayLength) % delayLength;
+
+            line[position] = samples[i];
+            samples[i] = line[readPosition];
+
+            position = position + 1 == delayLength ? 0 : position + 1;
+        }
+
+        juce::FloatVectorOperations::multiply(samples, gains.data(), length);
+    }
+
+    delayPosition = position;
+}
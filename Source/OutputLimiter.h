@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    OutputLimiter.h
+
+    Optional brickwall limiter on the output, after the EQ. The true peak of
+    the signal decides the gain needed to stay under the ceiling, a sliding
+    minimum holds that gain for the lookahead window and a moving average of
+    the same length ramps into it, so the gain has already arrived by the time
+    the delayed peak gets there. Release is a one pole back up towards unity.
+
+    Everything is allocated in prepare for the longest lookahead, changing it
+    only moves the read position.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TruePeakDetector.h"
+
+class OutputLimiter
+{
+public:
+    static constexpr float maxLookaheadMs = 5.f;
+
+    void prepare(double sampleRate, int numChannels, int maximumBlockSize);
+    void reset();
+
+    // Audio thread. A new lookahead resets the limiter, as it moves the delay anyway
+    void setParameters(float ceilingInDecibels, float lookaheadMs, float releaseMs);
+
+    void process(juce::AudioBuffer<float>& buffer);
+
+    int getLatencyInSamples() const { return lookahead; }
+
+    // Lowest gain applied in the last block, for metering
+    float getGainReductionInDecibels() const { return gainReductionInDecibels.load(std::memory_order_relaxed); }
+
+private:
+    void processChunk(juce::AudioBuffer<float>& buffer, int start, int length);
+
+    double sampleRate = 44100.0;
+    int numChannels = 0, maxBlockSize = 0;
+
+    float ceiling = 1.f, releaseCoefficient = 0.f;
+    int lookahead = 0, window = 1; // delay, and the ramp it leaves after the detector's own latency
+    int maxLookahead = 0;
+
+    TruePeakDetector truePeak;
+
+    // delay line, maxLookahead + 1 samples per channel
+    std::vector<float> delay;
+    int delayPosition = 0;
+
+    // sliding minimum of the required gain, kept as a monotonic queue in a ring
+    std::vector<float> minimumValues;
+    std::vector<juce::uint32> minimumTimes; // unsigned so the age still works out after wrapping
+    juce::uint32 time = 0;
+    int minimumHead = 0, minimumSize = 0;
+
+    // moving average over the same window
+    std::vector<float> averageHistory;
+    int averagePosition = 0;
+    double averageSum = 0;
+
+    float envelope = 1.f;
+
+    // per block scratch, sized in prepare
+    std::vector<float> peaks, gains;
+
+    std::atomic<float> gainReductionInDecibels{ 0 };
+};
@@ -8,186 +8,114 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "MatchEQ.h"
 
 //==============================================================================
 
-void BigDialLAF::drawRotarySlider(juce::Graphics& g,
-    int x,
-    int y,
-    int width,
-    int height,
-    float sliderPosProportional,
-    float rotaryStartAngle,
-    float rotaryEndAngle,
-    juce::Slider& slider)
-{
-    auto radius = (float)juce::jmin(width / 2, height / 2) - 10.0f;
-    auto centreX = (float)x + (float)width * 0.5f;
-    auto centreY = (float)y + (float)height * 0.5f;
-    auto rx = centreX - radius;
-    auto ry = centreY - radius;
-    auto rw = radius * 2.0f;
-    auto angle = rotaryStartAngle + sliderPosProportional * (rotaryEndAngle - rotaryStartAngle);
-
-    // fill
-    g.setColour(juce::Colours::steelblue);
-    g.fillEllipse(rx, ry, rw, rw);
-
-    // outline
-    g.setColour(juce::Colours::lightsteelblue);
-    g.drawEllipse(rx, ry, rw, rw, 2.0f);
-
-    juce::Path p;
-    auto pointerLength = radius * 0.33f;
-    auto pointerThickness = 2.0f;
-    p.addRectangle(-pointerThickness * 0.5f, -radius, pointerThickness, pointerLength);
-    p.applyTransform(juce::AffineTransform::rotation(angle).translated(centreX, centreY));
-
-    // pointer
-    g.setColour(juce::Colours::lightsteelblue);
-    g.fillPath(p);
-
-}
-
-//==============================================================================
-
-void SmallDialLAF::drawRotarySlider(juce::Graphics& g,
-    int x,
-    int y,
-    int width,
-    int height,
-    float sliderPosProportional,
-    float rotaryStartAngle,
-    float rotaryEndAngle,
-    juce::Slider& slider)
+void LoadOverlay::paint(juce::Graphics& g)
 {
+    using namespace juce;
 
-    auto radius = (float)juce::jmin(width / 2, height / 2) - 12.0f;
-    auto centreX = (float)x + (float)width * 0.5f;
-    auto centreY = (float)y + (float)height * 0.5f;
-    auto rx = centreX - radius;
-    auto ry = centreY - radius;
-    auto rw = radius * 2.0f;
-    auto angle = rotaryStartAngle + sliderPosProportional * (rotaryEndAngle - rotaryStartAngle);
+    g.fillAll(Colours::black.withAlpha(0.75f));
 
-    // fill
-    g.setColour(juce::Colours::steelblue);
-    g.fillEllipse(rx, ry, rw, rw);
+    auto area = getLocalBounds().reduced(8, 6);
+    const int rowHeight = 16;
 
-    // outline
-    g.setColour(juce::Colours::lightsteelblue);
-    g.drawEllipse(rx, ry, rw, rw, 2.0f);
+    g.setFont(Font(Font::getDefaultMonospacedFontName(), 12.f, Font::plain));
+    g.setColour(Colours::lightsteelblue);
 
-    juce::Path p;
-    auto pointerLength = radius * 0.33f;
-    auto pointerThickness = 2.0f;
-    p.addRectangle(-pointerThickness * 0.5f, -radius, pointerThickness, pointerLength);
-    p.applyTransform(juce::AffineTransform::rotation(angle).translated(centreX, centreY));
+    g.drawText(String::formatted("Load %.1f%%  p99 %.1f%%  budget %.0f us",
+        snapshot.getLoadPercent(), snapshot.getPeakLoadPercent(), snapshot.budgetMicroseconds),
+        area.removeFromTop(rowHeight), Justification::left);
 
-    // pointer
-    g.setColour(juce::Colours::lightsteelblue);
-    g.fillPath(p);
+    g.drawText(String::formatted("%-13s %8s %8s %8s", "us", "mean", "p99", "max"),
+        area.removeFromTop(rowHeight), Justification::left);
 
-}
+    g.setColour(Colours::white);
 
-//==============================================================================
+    for (int stage = 0; stage < DspLoadMonitor::numStages; ++stage)
+    {
+        const auto& stats = snapshot.stages[static_cast<size_t>(stage)];
 
-Placeholder::Placeholder()
-{
-    juce::Random r;
-    customColour = juce::Colour(r.nextInt(255), r.nextInt(255), r.nextInt(255));
+        g.drawText(String::formatted("%-13s %8.1f %8.1f %8.1f", DspLoadMonitor::getStageName(stage),
+            stats.meanMicroseconds, stats.p99Microseconds, stats.maxMicroseconds),
+            area.removeFromTop(rowHeight), Justification::left);
+    }
 }
-//==============================================================================
 
-void LowCutControls::paint(juce::Graphics& g)
+void LoadOverlay::mouseDown(const juce::MouseEvent&)
 {
-    using namespace juce;
-    auto bounds = getLocalBounds();
-    g.setColour(juce::Colours::steelblue);
-    g.fillAll();
-
-    auto localBounds = getLocalBounds();
-
-    bounds.reduce(3, 3);
-    g.setColour(juce::Colours::slategrey);
-    g.fillRoundedRectangle(bounds.toFloat(), 3);
+    juce::SystemClipboard::copyTextToClipboard(snapshot.toJSON());
 }
 
 //==============================================================================
 
-void PeakControls::paint(juce::Graphics& g)
+void LoudnessReadout::paint(juce::Graphics& g)
 {
     using namespace juce;
-    auto bounds = getLocalBounds();
-    g.setColour(juce::Colours::steelblue);
-    g.fillAll();
 
-    auto localBounds = getLocalBounds();
+    auto format = [](float value)
+        {
+            return value <= LoudnessMeter::silence ? String("-inf") : String(value, 1);
+        };
 
-    bounds.reduce(3, 3);
-    g.setColour(juce::Colours::slategrey);
-    g.fillRoundedRectangle(bounds.toFloat(), 3);
-}
+    g.fillAll(Colours::slategrey); // same as the panel it sits on
 
-//==============================================================================
+    auto area = getLocalBounds();
+    const int rowHeight = area.getHeight() / 4;
 
-void HighCutControls::paint(juce::Graphics& g)
-{
-    using namespace juce;
-    auto bounds = getLocalBounds();
-    g.setColour(juce::Colours::steelblue);
-    g.fillAll();
+    g.setFont(11.f);
 
-    auto localBounds = getLocalBounds();
+    auto drawRow = [&](const String& name, float value, bool warning)
+        {
+            auto row = area.removeFromTop(rowHeight);
+            g.setColour(Colours::lightsteelblue);
+            g.drawText(name, row.removeFromLeft(18), Justification::centredLeft);
+            g.setColour(warning ? Colours::orangered : Colours::white);
+            g.drawText(format(value), row, Justification::centredRight);
+        };
 
-    bounds.reduce(3, 3);
-    g.setColour(juce::Colours::slategrey);
-    g.fillRoundedRectangle(bounds.toFloat(), 3);
+    drawRow("M", momentary, false);
+    drawRow("S", shortTerm, false);
+    drawRow("I", integrated, false);
+    drawRow("TP", truePeak, truePeak > -1.f); // the usual -1 dBTP delivery ceiling
 }
 
 //==============================================================================
 
-void GainControls::paint(juce::Graphics& g)
+void DialLAF::drawRotarySlider(juce::Graphics& g,
+    int x,
+    int y,
+    int width,
+    int height,
+    float sliderPosProportional,
+    float rotaryStartAngle,
+    float rotaryEndAngle,
+    juce::Slider& slider)
 {
-    using namespace juce;
-    auto bounds = getLocalBounds();
-    g.setColour(juce::Colours::steelblue);
-    g.fillAll();
-
-    auto localBounds = getLocalBounds();
+    auto radius = (float)juce::jmin(width / 2, height / 2) - inset;
+    auto centreX = (float)x + (float)width * 0.5f;
+    auto centreY = (float)y + (float)height * 0.5f;
 
-    bounds.reduce(3, 3);
-    g.setColour(juce::Colours::slategrey);
-    g.fillRoundedRectangle(bounds.toFloat(), 3);
+    sprites->draw(g, { centreX, centreY }, radius, sliderPosProportional, rotaryStartAngle, rotaryEndAngle);
 }
 
 //==============================================================================
 
-void Analyzer::paint(juce::Graphics& g)
+Placeholder::Placeholder()
 {
-    using namespace juce;
-    auto bounds = getLocalBounds();
-    g.setColour(juce::Colours::steelblue);
-    g.fillAll();
-
-    auto localBounds = getLocalBounds();
-
-    bounds.reduce(3, 3);
-    g.setColour(juce::Colours::slategrey);
-    g.fillRoundedRectangle(bounds.toFloat(), 3);
+    juce::Random r;
+    customColour = juce::Colour(r.nextInt(255), r.nextInt(255), r.nextInt(255));
 }
-
 //==============================================================================
 
-void TitleBlock::paint(juce::Graphics& g)
+void Panel::paint(juce::Graphics& g)
 {
     using namespace juce;
     auto bounds = getLocalBounds();
     g.setColour(juce::Colours::steelblue);
     g.fillAll();
 
-    auto localBounds = getLocalBounds();
-
     bounds.reduce(3, 3);
     g.setColour(juce::Colours::slategrey);
     g.fillRoundedRectangle(bounds.toFloat(), 3);
@@ -307,6 +235,12 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor(SimpleEQAudioProcesso
     outGainSlider.setTextValueSuffix(" dB");
     outGainSlider.addListener(this);
 
+    addAndMakeVisible(loudnessReadout);
+    loudnessReadout.onReset = [this]
+        {
+            audioProcessor.getLoudnessMeter().requestReset();
+        };
+
     addAndMakeVisible(outGainLabel);
     outGainLabel.setText("  Out Gain", juce::NotificationType::dontSendNotification);
     outGainLabel.setSize(100, 20);
@@ -319,6 +253,36 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor(SimpleEQAudioProcesso
     titleLabel.setFont(juce::Font(35.0f, juce::Font::bold));
     titleLabel.setJustificationType(juce::Justification::horizontallyCentred);
 
+    // Snapshot slots
+    addAndMakeVisible(snapshotSelect);
+    snapshotSelect.addItemList(audioProcessor.apvts.getParameter("Snapshot")->getAllValueStrings(), 1);
+    snapshotAttachment = std::make_unique<comboBoxAttachment>(audioProcessor.apvts, "Snapshot", snapshotSelect);
+
+    // DSP load overlay, hidden until asked for
+    addAndMakeVisible(loadButton);
+    loadButton.setClickingTogglesState(true);
+    loadButton.onClick = [this]
+        {
+            loadOverlay.setVisible(loadButton.getToggleState());
+        };
+
+    addChildComponent(loadOverlay);
+
+    addAndMakeVisible(phaseButton);
+    phaseButton.onClick = [this]
+        {
+            curveMode = (curveMode + 1) % 3;
+            phaseButton.setButtonText(curveMode == CurveMode_GroupDelay ? "Delay" : "Phase");
+            phaseButton.setToggleState(curveMode != CurveMode_Magnitude, juce::dontSendNotification);
+
+            updateResponseCurve();
+            repaint(gridLines.getBounds());
+        };
+
+    // Match EQ
+    addAndMakeVisible(matchButton);
+    matchButton.onClick = [this] { chooseMatchFiles(); };
+
     // Big Dial LAF
 
     lowFreqDial.setLookAndFeel(&bigDialLAF);
@@ -333,6 +297,8 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor(SimpleEQAudioProcesso
 
 SimpleEQAudioProcessorEditor::~SimpleEQAudioProcessorEditor()
 {
+    snapshotAttachment.reset();
+
     lowFreqDial.setLookAndFeel(nullptr);
     highFreqDial.setLookAndFeel(nullptr);
     peakFreqDial.setLookAndFeel(nullptr);
@@ -355,56 +321,62 @@ void SimpleEQAudioProcessorEditor::paint(juce::Graphics& g)
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll(juce::Colours::black); // NOTE: this is the background of the visualizer
 
-    // Drawing response curve
     auto responseArea = gridLines.getBounds();
-    auto w = responseArea.getWidth();
+    // For Response curve Grid
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
 
-    auto& lowcut = monoChain.get<ChainPositions::LowCut>();
-    auto& peak = monoChain.get<ChainPositions::Peak>();
-    auto& highcut = monoChain.get<ChainPositions::HighCut>();
+    if (background.getWidth() != roundToInt(responseArea.getWidth() * scale)
+        || background.getHeight() != roundToInt(responseArea.getHeight() * scale))
+        renderBackground(scale);
 
-    auto sampleRate = audioProcessor.getSampleRate();
+    g.drawImage(background, responseArea.toFloat());
 
-    std::vector<double> mags;
 
-    mags.resize(w);
+    // For Response Curve
+    g.setColour(Colours::steelblue); // colour of border
+    g.drawRoundedRectangle(responseArea.toFloat(), 3, 3);
 
-    for (int i = 0; i < w; ++i)
+    if (curveMode != CurveMode_Magnitude)
     {
-        double mag = 1.f;
-        auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
-        mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+        g.setColour(Colours::orange.withAlpha(0.8f));
+        g.strokePath(phaseCurve, PathStrokeType(1.5f));
 
-        if (!lowcut.isBypassed<0>()) {
-            mag *= lowcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!lowcut.isBypassed<1>()) {
-            mag *= lowcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!lowcut.isBypassed<2>()) {
-            mag *= lowcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!lowcut.isBypassed<3>()) {
-            mag *= lowcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
+        g.setFont(10.f);
+        g.drawText(curveMode == CurveMode_Phase ? "Phase -180...180 deg" : "Group delay 0..." + String(maxGroupDelayMs) + " ms",
+            responseArea.reduced(6, 4).removeFromTop(12), Justification::centredLeft);
+    }
 
-        if (!highcut.isBypassed<0>()) {
-            mag *= highcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!highcut.isBypassed<1>()) {
-            mag *= highcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!highcut.isBypassed<2>()) {
-            mag *= highcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!highcut.isBypassed<3>()) {
-            mag *= highcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
+    g.setColour(Colours::white); // colour of line
+    g.strokePath(responseCurve, PathStrokeType(2.f));
 
-        mags[i] = Decibels::gainToDecibels(mag);
-    }
+    analyzer.setVisible(false);
+    gridLines.setVisible(false);
 
-    Path responseCurve;
+}
+
+void SimpleEQAudioProcessorEditor::updateResponseCurve()
+{
+    using namespace juce;
+
+    auto responseArea = gridLines.getBounds();
+
+    responseCurve.clear();
+    phaseCurve.clear();
+
+    // no rate before prepareToPlay, so nothing to draw yet
+    const auto sampleRate = audioProcessor.getProcessingSampleRate();
+
+    if (sampleRate <= 0)
+        return;
+
+    // only the stages that changed since last time get evaluated again, see ResponseCurves
+    responseCurves.setFrequencies(responseArea.getWidth(), sampleRate);
+    responseCurves.update();
+
+    const auto& mags = responseCurves.getMagnitudes();
+
+    if (mags.empty())
+        return;
 
     const double outputMin = responseArea.getBottom();
     const double outputMax = responseArea.getY();
@@ -420,20 +392,86 @@ void SimpleEQAudioProcessorEditor::paint(juce::Graphics& g)
         responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
     }
 
-    // For Response curve Grid
-    g.drawImage(background, gridLines.getBounds().toFloat());
+    if (curveMode == CurveMode_Phase)
+    {
+        const auto& phases = responseCurves.getPhases();
+        phaseCurve.startNewSubPath(responseArea.getX(), jmap(phases.front(), -180.0, 180.0, outputMin, outputMax));
 
+        for (int i = 1; i < phases.size(); ++i)
+        {
+            const auto y = jmap(phases[i], -180.0, 180.0, outputMin, outputMax);
 
-    // For Response Curve
-    g.setColour(Colours::steelblue); // colour of border
-    g.drawRoundedRectangle(responseArea.toFloat(), 3, 3);
+            // a wrap from -180 to 180 starts a new piece instead of a line across the whole display
+            if (std::abs(phases[i] - phases[i - 1]) > 180.0)
+                phaseCurve.startNewSubPath(responseArea.getX() + i, y);
+            else
+                phaseCurve.lineTo(responseArea.getX() + i, y);
+        }
+    }
+    else if (curveMode == CurveMode_GroupDelay)
+    {
+        const auto& delays = responseCurves.getGroupDelays();
+        auto mapDelay = [outputMin, outputMax](double delay)
+            {
+                return jmap(jlimit(0.0, maxGroupDelayMs, delay), 0.0, maxGroupDelayMs, outputMin, outputMax);
+            };
 
-    g.setColour(Colours::white); // colour of line
-    g.strokePath(responseCurve, PathStrokeType(2.f));
+        phaseCurve.startNewSubPath(responseArea.getX(), mapDelay(delays.front()));
 
-    analyzer.setVisible(false);
-    gridLines.setVisible(false);
+        for (int i = 1; i < delays.size(); ++i)
+            phaseCurve.lineTo(responseArea.getX() + i, mapDelay(delays[i]));
+    }
+}
+
+void SimpleEQAudioProcessorEditor::renderBackground(float scale)
+{
+    using namespace juce;
+
+    const auto area = gridLines.getLocalBounds().toFloat();
+
+    background = Image(Image::ARGB,
+        jmax(1, roundToInt(area.getWidth() * scale)),
+        jmax(1, roundToInt(area.getHeight() * scale)),
+        true);
+
+    Graphics g(background);
+    g.addTransform(AffineTransform::scale(scale));
+
+    // same mapping as the response curve, log frequency across and -24..24 dB up
+    auto xForFreq = [&area](double freq)
+        {
+            return area.getX() + (float)mapFromLog10(freq, 20.0, 20000.0) * area.getWidth();
+        };
+
+    auto yForGain = [&area](double gain)
+        {
+            return (float)jmap(gain, -24.0, 24.0, (double)area.getBottom(), (double)area.getY());
+        };
+
+    g.setFont(10.f);
 
+    for (auto freq : { 50.0, 100.0, 200.0, 500.0, 1000.0, 2000.0, 5000.0, 10000.0 })
+    {
+        const auto x = xForFreq(freq);
+
+        g.setColour(Colours::dimgrey.withAlpha(0.5f));
+        g.drawVerticalLine(roundToInt(x), area.getY(), area.getBottom());
+
+        g.setColour(Colours::lightgrey);
+        g.drawText(freq >= 1000.0 ? String(freq / 1000.0) + "k" : String(freq),
+            Rectangle<float>(x + 2.f, area.getBottom() - 14.f, 30.f, 12.f), Justification::centredLeft);
+    }
+
+    for (auto gain : { -12.0, 0.0, 12.0 })
+    {
+        const auto y = yForGain(gain);
+
+        g.setColour(gain == 0.0 ? Colours::grey : Colours::dimgrey.withAlpha(0.5f));
+        g.drawHorizontalLine(roundToInt(y), area.getX(), area.getRight());
+
+        g.setColour(Colours::lightgrey);
+        g.drawText(String(gain) + " dB", Rectangle<float>(area.getRight() - 42.f, y - 12.f, 40.f, 12.f), Justification::centredRight);
+    }
 }
 
 void SimpleEQAudioProcessorEditor::resized()
@@ -463,13 +501,82 @@ void SimpleEQAudioProcessorEditor::resized()
     peakQDial.setBounds(peakControl.getBounds().removeFromBottom(65).removeFromTop(65).removeFromRight(55).removeFromLeft(50));
     peakGainDial.setBounds(peakControl.getBounds().removeFromBottom(65).removeFromTop(65).removeFromLeft(55).removeFromRight(50));
 
-    outGainSlider.setBounds(gainControl.getBounds().removeFromTop(380).removeFromBottom(360));
+    outGainSlider.setBounds(gainControl.getBounds().removeFromTop(320).removeFromBottom(300));
+    loudnessReadout.setBounds(gainControl.getBounds().removeFromBottom(90).removeFromTop(60).reduced(8, 0));
     outGainLabel.setBounds(gainControl.getBounds().removeFromBottom(30));
 
     titleLabel.setBounds(titleBlock.getBounds().removeFromBottom(45).removeFromLeft(100));
+    snapshotSelect.setBounds(titleBlock.getBounds().removeFromRight(70).reduced(8, 12));
+    loadButton.setBounds(titleBlock.getBounds().removeFromRight(120).removeFromLeft(50).reduced(4, 12));
+    matchButton.setBounds(titleBlock.getBounds().removeFromRight(180).removeFromLeft(60).reduced(4, 12));
+    phaseButton.setBounds(titleBlock.getBounds().removeFromRight(240).removeFromLeft(60).reduced(4, 12));
+
+    loadOverlay.setBounds(analyzer.getBounds());
+
+    updateResponseCurve();
   
 }
 
+void SimpleEQAudioProcessorEditor::chooseMatchFiles()
+{
+    auto& matchEQ = audioProcessor.getMatchEQ();
+
+    if (matchEQ.isBusy())
+        return;
+
+    // reference first, then the material it should be matched to
+    const bool choosingReference = matchReference == juce::File();
+
+    fileChooser = std::make_unique<juce::FileChooser>(
+        choosingReference ? "Choose the reference" : "Choose the material to match",
+        juce::File(),
+        matchEQ.getWildcard());
+
+    fileChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+        [this, choosingReference](const juce::FileChooser& chooser)
+        {
+            const auto file = chooser.getResult();
+
+            if (file == juce::File())
+            {
+                matchReference = juce::File();
+                return;
+            }
+
+            if (choosingReference)
+            {
+                matchReference = file;
+
+                // not from inside this chooser's own callback, the next one replaces it
+                juce::MessageManager::callAsync([safeThis = juce::Component::SafePointer<SimpleEQAudioProcessorEditor>(this)]
+                    {
+                        if (safeThis != nullptr)
+                            safeThis->chooseMatchFiles();
+                    });
+                return;
+            }
+
+            matchButton.setButtonText("...");
+            matchButton.setEnabled(false);
+
+            audioProcessor.getMatchEQ().match(matchReference, file, audioProcessor.getProcessingSampleRate(),
+                [safeThis = juce::Component::SafePointer<SimpleEQAudioProcessorEditor>(this)](bool succeeded, const juce::String& message)
+                {
+                    if (safeThis == nullptr)
+                        return;
+
+                    safeThis->matchButton.setButtonText("Match");
+                    safeThis->matchButton.setEnabled(true);
+                    safeThis->matchButton.setTooltip(message);
+
+                    if (!succeeded)
+                        juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Match EQ", message);
+                });
+
+            matchReference = juce::File();
+        });
+}
+
 void SimpleEQAudioProcessorEditor::sliderValueChanged(juce::Slider* slider)
 {
 
@@ -483,26 +590,32 @@ void SimpleEQAudioProcessorEditor::parameterValueChanged(int parameterIndex, flo
 
 void SimpleEQAudioProcessorEditor::timerCallback()
 {
-    if (parameterChanged.compareAndSetBool(false, true))
+    // Before prepareToPlay there's no rate to design at, the flag stays set so the first tick after it draws
+    const auto sampleRate = audioProcessor.getProcessingSampleRate();
+
+    if (sampleRate > 0 && parameterChanged.compareAndSetBool(false, true))
     {
-        // update monochain
-        auto chainSettings = getChainSettings(audioProcessor.apvts);
-        auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-        updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+        // same design the processor runs, without allocating a Coefficients object per section
+        designChainCoefficients(curveCoefficients, getChainSettings(audioProcessor.apvts), sampleRate);
+        responseCurves.setChain(curveCoefficients);
 
-        auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-        auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
+        updateResponseCurve();
 
-        updateCutFilter(monoChain.get<ChainPositions::LowCut>(),
-            lowCutCoefficients,
-            static_cast<Slope>(chainSettings.lowCutSlope));
+        //signal repaint
+        repaint(gridLines.getBounds());
+    }
 
-        updateCutFilter(monoChain.get<ChainPositions::HighCut>(),
-            highCutCoefficients,
-            static_cast<Slope>(chainSettings.highCutSlope));
+    auto& meter = audioProcessor.getLoudnessMeter();
+    loudnessReadout.momentary = meter.getMomentaryLoudness();
+    loudnessReadout.shortTerm = meter.getShortTermLoudness();
+    loudnessReadout.integrated = meter.getIntegratedLoudness();
+    loudnessReadout.truePeak = meter.getTruePeakInDecibels();
+    loudnessReadout.repaint();
 
-        //signal repaint
-        repaint();
+    if (loadOverlay.isVisible())
+    {
+        loadOverlay.snapshot = audioProcessor.getDspLoad();
+        loadOverlay.repaint();
     }
 }
 
@@ -10,6 +10,8 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "DialSpriteCache.h"
+#include "ResponseCurves.h"
 
 //==============================================================================
 
@@ -28,49 +30,65 @@ struct Placeholder : juce::Component
 
 //==============================================================================
 
-struct LowCutControls : juce::Component
+// Background block behind a group of controls. It never changes, so JUCE keeps it as
+// an image (redrawn only when the size or scale changes) and just blits that
+struct Panel : juce::Component
 {
-    void paint(juce::Graphics& g) override;
-};
+    Panel()
+    {
+        setOpaque(true);
+        setBufferedToImage(true);
+    }
 
-struct PeakControls : juce::Component
-{
     void paint(juce::Graphics& g) override;
 };
 
-struct HighCutControls : juce::Component
-{
-    void paint(juce::Graphics& g) override;
-};
+struct LowCutControls : Panel {};
 
-struct GainControls : juce::Component
-{
-    void paint(juce::Graphics& g) override;
-};
+struct PeakControls : Panel {};
+
+struct HighCutControls : Panel {};
+
+struct GainControls : Panel {};
+
+struct Analyzer : Panel {};
+
+struct TitleBlock : Panel {};
 
-struct Analyzer : juce::Component
+// Per stage DSP timings drawn over the response area, clicking it copies them as JSON
+struct LoadOverlay : juce::Component
 {
+    DspLoadMonitor::Snapshot snapshot;
+
     void paint(juce::Graphics& g) override;
+    void mouseDown(const juce::MouseEvent&) override;
 };
 
-struct TitleBlock : juce::Component
+// Output loudness and true peak under the out gain slider, clicking it starts a new measurement
+struct LoudnessReadout : juce::Component
 {
+    LoudnessReadout() { setOpaque(true); } // so the 60 ms updates don't repaint the editor behind it
+
+    float momentary = LoudnessMeter::silence, shortTerm = LoudnessMeter::silence;
+    float integrated = LoudnessMeter::silence, truePeak = LoudnessMeter::silence;
+
+    std::function<void()> onReset;
+
     void paint(juce::Graphics& g) override;
+    void mouseDown(const juce::MouseEvent&) override { if (onReset) onReset(); }
 };
 
-struct BigDialLAF : juce::LookAndFeel_V4
+// Big and small dials only differ in how far the dial sits inside the slider's bounds
+struct DialLAF : juce::LookAndFeel_V4
 {
-    void drawRotarySlider(juce::Graphics&, int x, int y, int width, int height,
-        float sliderPosProportional, float rotaryStartAngle,
-        float rotaryEndAngle, juce::Slider&) override;
-};
+    explicit DialLAF(float insetToUse) : inset(insetToUse) {}
 
-struct SmallDialLAF : juce::LookAndFeel_V4
-{
     void drawRotarySlider(juce::Graphics&, int x, int y, int width, int height,
         float sliderPosProportional, float rotaryStartAngle,
         float rotaryEndAngle, juce::Slider&) override;
 
+    float inset;
+    juce::SharedResourcePointer<DialSpriteCache> sprites; // shared by every editor
 };
 
 //==============================================================================
@@ -99,7 +117,7 @@ private:
 
     juce::Image background;
 
-    juce::Atomic<bool> parameterChanged{ false };
+    juce::Atomic<bool> parameterChanged{ true }; // so the first timer tick draws the current settings
 
     juce::Slider lowFreqDial{ "lowFreqDial" };
     juce::Label lowFreqLabel{ "Low Cut Frequency" };
@@ -119,12 +137,26 @@ private:
     juce::Slider outGainSlider{ "outGainSlider" };
     juce::Label outGainLabel{ "Output Gain" };
 
+    LoudnessReadout loudnessReadout;
+
     juce::Slider lowSlopeSelect{ "lowSlopeSelect" };
 
     juce::Slider highSlopeSelect{ "highSlopeSelect" };
 
     juce::Label titleLabel;
 
+    juce::ComboBox snapshotSelect; // A/B/C/D settings slots
+
+    juce::TextButton loadButton{ "Load" }; // toggles the DSP load overlay
+
+    juce::TextButton phaseButton{ "Phase" }; // cycles the extra curve: none, phase, group delay
+
+    juce::TextButton matchButton{ "Match" }; // fits the EQ to a reference file
+    std::unique_ptr<juce::FileChooser> fileChooser;
+    juce::File matchReference;
+
+    void chooseMatchFiles();
+
 
 
     SimpleEQAudioProcessor& audioProcessor;
@@ -133,8 +165,9 @@ private:
     using sliderAttachment = APVTS::SliderAttachment;
     using comboBoxAttachment = APVTS::ComboBoxAttachment;
 
-    // For Response Curve
-    MonoChain monoChain;
+    // For Response Curve, designed the same way the processor does it
+    ChainCoefficients curveCoefficients;
+    ResponseCurves responseCurves;
 
 
     sliderAttachment // connects it to the parameter in the process block
@@ -147,6 +180,8 @@ private:
         lowSlopeSliderAttachment,
         highSlopeSliderAttachment;
 
+    std::unique_ptr<comboBoxAttachment> snapshotAttachment; // made after the items are in
+
     LowCutControls lowControl;
 
     PeakControls peakControl;
@@ -161,10 +196,31 @@ private:
 
     TitleBlock titleBlock;
 
+    LoadOverlay loadOverlay;
+
+
+    DialLAF bigDialLAF{ 10.f };
+
+    DialLAF smallDialLAF{ 12.f };
+
+    // Response curve only changes with the parameters, so it's rebuilt then rather than on every paint
+    juce::Path responseCurve;
+    void updateResponseCurve();
+
+    enum CurveMode
+    {
+        CurveMode_Magnitude,
+        CurveMode_Phase,      // -180...180 degrees over the whole height
+        CurveMode_GroupDelay  // 0...maxGroupDelayMs from the bottom
+    };
+
+    static constexpr double maxGroupDelayMs = 10.0;
 
-    BigDialLAF bigDialLAF;
+    int curveMode = CurveMode_Magnitude;
+    juce::Path phaseCurve; // phase or group delay, whichever curveMode asks for
 
-    SmallDialLAF smallDialLAF;
+    // Grid behind the response curve, rendered into background for the current size and scale
+    void renderBackground(float scale);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SimpleEQAudioProcessorEditor)
 };
@@ -8,6 +8,10 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "LinearPhaseEQ.h"
+#include "CoefficientDesigner.h"
+#include "MatchEQ.h"
+#include "WorkStealingPool.h"
 
 //==============================================================================
 SimpleEQAudioProcessor::SimpleEQAudioProcessor()
@@ -16,16 +20,27 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
 #if ! JucePlugin_IsMidiEffect
 #if ! JucePlugin_IsSynth
         .withInput("Input", juce::AudioChannelSet::stereo(), true)
+        .withInput("Sidechain", juce::AudioChannelSet::stereo(), false) // optional key for the dynamic peak
 #endif
         .withOutput("Output", juce::AudioChannelSet::stereo(), true)
 #endif
     )
 #endif
 {
+    linearPhaseEQ = std::make_unique<LinearPhaseEQ>(apvts);
+    coefficientDesigner = std::make_unique<CoefficientDesigner>(apvts);
+    matchEQ = std::make_unique<MatchEQ>(apvts);
+
+    // the kernel only gets rebuilt when there's something new, not on a timer
+    coefficientDesigner->onNewSettings = [this](const ChainSettings& chainSettings) { linearPhaseEQ->setSettings(chainSettings); };
+
+    traceRecorder.startFromEnvironment();
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+    // its worker calls into linearPhaseEQ, which would otherwise go first
+    coefficientDesigner.reset();
 }
 
 //==============================================================================
@@ -95,17 +110,113 @@ void SimpleEQAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBloc
 {
     juce::dsp::ProcessSpec spec; // the block to be passed into the filters
 
-    previousGain = pow(10, *apvts.getRawParameterValue("Output Gain") / 20);
+    const auto numChannels = static_cast<size_t>(juce::jmax(1, getTotalNumOutputChannels()));
+
+    // Hosts call this again for block size changes, offline renders and graph rebuilds, sometimes dozens of
+    // times while a session loads. When the rate and channels are the same and the block still fits, every
+    // buffer, filter and designed coefficient is still good, so clearing the state is all there is to do.
+    if (!needsFullPrepare && sampleRate == preparedSampleRate
+        && static_cast<int>(numChannels) == preparedNumChannels && samplesPerBlock <= preparedBlockSize)
+    {
+        dspLoadMonitor.prepare(sampleRate, samplesPerBlock); // the budget follows the actual block size
+        reset();
+        return;
+    }
 
-    spec.maximumBlockSize = samplesPerBlock;
+    // Build every oversampler up front, the active one is picked per block in updateOversampling.
+    // The half-band filters don't depend on the rate, so they only get rebuilt when they no longer fit.
+    if (static_cast<int>(numChannels) != oversamplerNumChannels || samplesPerBlock > oversamplerBlockSize)
+    {
+        for (int filter = 0; filter < 2; ++filter)
+        {
+            const auto filterType = filter == OversamplingFilter::OversamplingFilter_IIR
+                ? juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR
+                : juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple;
+
+            for (int factor = 1; factor <= 3; ++factor) // factor is the number of 2x stages
+            {
+                auto& oversampler = oversamplers[filter * 3 + factor - 1];
+                oversampler = std::make_unique<juce::dsp::Oversampling<float>>(numChannels, factor, filterType, true, true);
+                oversampler->initProcessing(static_cast<size_t>(samplesPerBlock));
+            }
+        }
+
+        oversamplerNumChannels = static_cast<int>(numChannels);
+        oversamplerBlockSize = samplesPerBlock;
+    }
+    else
+    {
+        for (auto& oversampler : oversamplers)
+            oversampler->reset();
+    }
+
+    activeOversampler = nullptr;
+    activeOversamplerIndex = -1;
+    oversamplingFactor = 1;
+
+    spec.maximumBlockSize = samplesPerBlock * 8; // room for the highest oversampling factor
     spec.numChannels = 1;
     spec.sampleRate = sampleRate;
 
-    leftChain.prepare(spec); // send to filters, they process stuff in mono so you have to split them here
-    rightChain.prepare(spec);
+    for (auto& chainSet : chainSets)
+        chainSet.prepare(spec); // send to filters, they process stuff in mono so you have to split them here
 
-    updateFilters();
+    activeChainSet = 0;
+    fadeSamplesRemaining = 0;
 
+    // Plain stereo at a normal block size and the current oversampling never gets past the thresholds,
+    // so it doesn't hold on to the shared pool for nothing
+    const auto currentFactor = 1 << static_cast<int>(apvts.getRawParameterValue("Oversampling")->load());
+    const auto canGoParallel = numChannels > 1
+        && (static_cast<int>(numChannels) >= parallelMinChannels || samplesPerBlock * currentFactor >= parallelMinSamples);
+
+    if (canGoParallel)
+    {
+        if (channelPool == nullptr)
+            channelPool = std::make_unique<juce::SharedResourcePointer<SharedChannelPool>>();
+    }
+    else
+    {
+        channelPool.reset();
+    }
+    fadeBuffer.setSize(static_cast<int>(numChannels), samplesPerBlock * 8, false, false, true);
+
+    dynamicPeak.prepare(sampleRate, samplesPerBlock);
+    modulation.prepare(sampleRate, samplesPerBlock);
+    modulationActive = false;
+    dspLoadMonitor.prepare(sampleRate, samplesPerBlock);
+    loudnessMeter.prepare(sampleRate, static_cast<int>(numChannels));
+    outputLimiter.prepare(sampleRate, static_cast<int>(numChannels), samplesPerBlock);
+
+    // The linear phase path always runs at the host rate
+    juce::dsp::ProcessSpec linearPhaseSpec;
+    linearPhaseSpec.maximumBlockSize = samplesPerBlock;
+    linearPhaseSpec.numChannels = numChannels;
+    linearPhaseSpec.sampleRate = sampleRate;
+
+    linearPhaseEQ->prepare(linearPhaseSpec);
+
+    // First set is designed right here so the very first block already has proper coefficients
+    coefficientDesigner->prepare(sampleRate);
+
+    auto* coefficients = coefficientDesigner->getNewCoefficients();
+    currentSettings = coefficients->settings;
+    autoGainInDecibels = coefficients->autoGainInDecibels;
+    numRejectedSections = coefficients->numRejectedSections;
+    previousGain = pow(10, (*apvts.getRawParameterValue("Output Gain") + autoGainInDecibels) / 20);
+
+    activePhaseMode = currentSettings.phaseMode;
+    limiterActive = false;
+
+    updateOversampling(currentSettings);
+    updateLimiter(currentSettings);
+    updateLatency();
+    applyChainCoefficients(*coefficients, chainSets[activeChainSet]);
+
+    preparedSampleRate = sampleRate;
+    preparedNumChannels = static_cast<int>(numChannels);
+    preparedBlockSize = samplesPerBlock; // the fade buffer, convolution, dynamic peak etc. were all sized for exactly this
+    needsFullPrepare = false;
 }
 
 void SimpleEQAudioProcessor::releaseResources()
@@ -114,6 +225,12 @@ void SimpleEQAudioProcessor::releaseResources()
     // spare memory, etc.
 }
 
+void SimpleEQAudioProcessor::reset()
+{
+    // the loudness readings are left alone, those only clear when asked to
+    resetProcessingState();
+}
+
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool SimpleEQAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
@@ -133,6 +250,17 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts)
 #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    // Sidechain can be off, mono or stereo
+    if (layouts.inputBuses.size() > 1)
+    {
+        const auto sidechain = layouts.getChannelSet(true, 1);
+
+        if (!sidechain.isDisabled()
+            && sidechain != juce::AudioChannelSet::mono()
+            && sidechain != juce::AudioChannelSet::stereo())
+            return false;
+    }
 #endif
 
     return true;
@@ -143,6 +271,16 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts)
 void SimpleEQAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    const auto blockStart = juce::Time::getHighResolutionTicks();
+
+    traceRecorder.record(TraceRecorder::Event_BlockBegin, buffer.getNumSamples());
+
+    if (bypassed)
+    {
+        bypassed = false;
+        traceRecorder.record(TraceRecorder::Event_Bypass, 0);
+    }
+
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -157,20 +295,295 @@ void SimpleEQAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce
     }
 
 
-    float currentGain = pow(10, *apvts.getRawParameterValue("Output Gain") / 20);
+    // Only the main bus gets processed, the sidechain (if there is one) sits after it in the buffer
+    auto mainBuffer = getBusBuffer(buffer, false, 0);
 
-    if (currentGain == previousGain) {
-        buffer.applyGain(currentGain);
+    // Coefficients first, so the auto gain that came with them ramps in over the same block
+    {
+        DspLoadMonitor::ScopedStage stage(dspLoadMonitor, DspLoadMonitor::Stage_Coefficients);
+        pickUpNewCoefficients();
     }
-    else {
-        buffer.applyGainRamp(0, buffer.getNumSamples(), previousGain, currentGain);
-        previousGain = currentGain;
+
+    {
+        DspLoadMonitor::ScopedStage stage(dspLoadMonitor, DspLoadMonitor::Stage_Gain);
+
+        float currentGain = pow(10, (*apvts.getRawParameterValue("Output Gain") + autoGainInDecibels) / 20);
+
+        if (currentGain == previousGain) {
+            mainBuffer.applyGain(currentGain);
+        }
+        else {
+            mainBuffer.applyGainRamp(0, mainBuffer.getNumSamples(), previousGain, currentGain);
+            previousGain = currentGain;
+        }
     }
 
+    const auto& chainSettings = currentSettings;
+
+    updatePhaseMode(chainSettings);
+    updateLimiter(chainSettings);
+    updateLatency();
+
+    // Detection runs at the host rate before any oversampling, keyed off the sidechain when asked to and connected
+    auto* sidechainBus = getBus(true, 1);
+
+    if (chainSettings.peakSidechain && sidechainBus != nullptr && sidechainBus->isEnabled())
+        dynamicPeak.analyse(getBusBuffer(buffer, true, 1), chainSettings);
+    else
+        dynamicPeak.analyse(mainBuffer, chainSettings);
 
-    updateFilters();
+    // Modulation looks at the input before any M/S or oversampling too
+    modulationActive = activePhaseMode == PhaseMode::PhaseMode_Minimum && Modulation::isActive(chainSettings);
 
-    juce::dsp::AudioBlock<float> block(buffer); // buffer has the audio information
+    if (!modulationActive)
+        numRejectedModulatedSections = 0;
+
+    if (modulationActive)
+    {
+        modulation.analyse(mainBuffer, chainSettings, getTransport());
+
+        if (chainSettings.peakDynamic && dynamicPeak.getNumControlSteps() > 0)
+        {
+            // the two can run at different intervals, each step takes the dynamic offset of where it starts
+            for (int step = 0; step < modulation.getNumControlSteps(); ++step)
+            {
+                const auto dynamicStep = step * modulation.getCurrentControlInterval() / DynamicPeak::controlInterval;
+                modulation.addPeakGainOffset(step, dynamicPeak.getGainOffset(juce::jmin(dynamicStep, dynamicPeak.getNumControlSteps() - 1)));
+            }
+        }
+    }
+
+    juce::dsp::AudioBlock<float> block(mainBuffer); // buffer has the audio information
+
+    // Mid/side just rotates the channels in place, the chains don't know the difference
+    const bool midSide = chainSettings.stereoMode == StereoMode::StereoMode_MidSide && mainBuffer.getNumChannels() > 1;
+
+    if (midSide)
+        encodeMidSide(mainBuffer.getWritePointer(0), mainBuffer.getWritePointer(1), mainBuffer.getNumSamples());
+
+    if (activePhaseMode == PhaseMode::PhaseMode_Linear)
+    {
+        linearPhaseEQ->process(block); // kernel is rebuilt on its own thread, nothing to design here
+    }
+    else if (activeOversampler != nullptr)
+    {
+        auto oversampledBlock = activeOversampler->processSamplesUp(block);
+        processChains(oversampledBlock, chainSettings);
+        activeOversampler->processSamplesDown(block);
+    }
+    else
+    {
+        processChains(block, chainSettings);
+    }
+
+    if (midSide)
+        decodeMidSide(mainBuffer.getWritePointer(0), mainBuffer.getWritePointer(1), mainBuffer.getNumSamples());
+
+    if (limiterActive)
+    {
+        DspLoadMonitor::ScopedStage stage(dspLoadMonitor, DspLoadMonitor::Stage_Limiter);
+        outputLimiter.process(mainBuffer);
+    }
+
+    guardOutput(mainBuffer);
+
+    loudnessMeter.process(mainBuffer); // whatever actually leaves the plugin
+
+    dspLoadMonitor.addStageTicks(DspLoadMonitor::Stage_Total, juce::Time::getHighResolutionTicks() - blockStart);
+    dspLoadMonitor.endBlock();
+
+    traceRecorder.record(TraceRecorder::Event_BlockEnd);
+}
+
+void SimpleEQAudioProcessor::processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    if (!bypassed)
+    {
+        bypassed = true;
+        traceRecorder.record(TraceRecorder::Event_Bypass, 1);
+    }
+
+    AudioProcessor::processBlockBypassed(buffer, midiMessages);
+}
+
+void SimpleEQAudioProcessor::setParallelThresholds(int minChannels, int minSamples)
+{
+    parallelMinChannels = juce::jmax(2, minChannels);
+    parallelMinSamples = juce::jmax(1, minSamples);
+
+    needsFullPrepare = true; // the pool gets sorted out in prepareToPlay, so the next one can't be skipped
+}
+
+bool SimpleEQAudioProcessor::guardOutput(juce::AudioBuffer<float>& buffer)
+{
+    const auto numSamples = buffer.getNumSamples();
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        const auto* samples = buffer.getReadPointer(channel);
+
+        // one pass that stops at the first NaN or Inf
+        if (!std::all_of(samples, samples + numSamples, [](float sample) { return std::isfinite(sample); }))
+        {
+            buffer.clear();
+            resetProcessingState();
+
+            ++numOutputGuardResets;
+            traceRecorder.record(TraceRecorder::Event_OutputGuard, channel);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void SimpleEQAudioProcessor::resetProcessingState()
+{
+    for (auto& chainSet : chainSets)
+        chainSet.reset();
+
+    // a fade in progress just ends on the incoming set, that's the one holding the current settings
+    if (fadeSamplesRemaining > 0)
+    {
+        activeChainSet = 1 - activeChainSet;
+        fadeSamplesRemaining = 0;
+    }
+
+    for (auto& oversampler : oversamplers)
+        if (oversampler != nullptr)
+            oversampler->reset();
+
+    linearPhaseEQ->reset();
+    dynamicPeak.reset();
+    modulation.reset();
+    outputLimiter.reset();
+}
+
+void SimpleEQAudioProcessor::pickUpNewCoefficients()
+{
+    // All the designing happens on the designer's thread, here it's just picking up the newest finished set
+    auto* newCoefficients = coefficientDesigner->getNewCoefficients();
+
+    if (newCoefficients == nullptr)
+        return;
+
+    const auto& newSettings = newCoefficients->settings;
+
+    traceRecorder.record(TraceRecorder::Event_Coefficients, newSettings.snapshot);
+
+    if (newSettings.snapshot != currentSettings.snapshot)
+        traceRecorder.record(TraceRecorder::Event_Snapshot, newSettings.snapshot);
+
+    // A snapshot switch gets crossfaded, as long as it's the IIR path and the rate stays the same
+    const bool crossfade = newSettings.snapshot != currentSettings.snapshot
+        && newSettings.oversampling == currentSettings.oversampling
+        && newSettings.phaseMode == PhaseMode::PhaseMode_Minimum
+        && activePhaseMode == PhaseMode::PhaseMode_Minimum;
+
+    if (crossfade)
+    {
+        // another switch in the middle of a fade, just jump to where the last one was heading
+        if (fadeSamplesRemaining > 0)
+            activeChainSet = 1 - activeChainSet;
+
+        auto& incoming = chainSets[1 - activeChainSet];
+        incoming.reset();
+        applyChainCoefficients(*newCoefficients, incoming);
+
+        fadeOutSettings = currentSettings;
+        fadeLengthSamples = juce::roundToInt(getProcessingSampleRate() * 0.03); // 30 ms
+        fadeSamplesRemaining = fadeLengthSamples;
+    }
+    else
+    {
+        updateOversampling(newSettings); // the set was designed for this rate, so switch together
+
+        // while fading the new settings belong to the incoming set
+        applyChainCoefficients(*newCoefficients, chainSets[fadeSamplesRemaining > 0 ? 1 - activeChainSet : activeChainSet]);
+    }
+
+    currentSettings = newSettings;
+    autoGainInDecibels = newCoefficients->autoGainInDecibels;
+    numRejectedSections = newCoefficients->numRejectedSections;
+}
+
+void SimpleEQAudioProcessor::processChains(juce::dsp::AudioBlock<float>& block, const ChainSettings& chainSettings)
+{
+    if (fadeSamplesRemaining <= 0)
+    {
+        processChainSet(chainSets[activeChainSet], block, chainSettings);
+        return;
+    }
+
+    // Both sets run for the length of the fade, the incoming one on a copy of the input
+    const auto numSamples = block.getNumSamples();
+    const auto numChannels = juce::jmin(block.getNumChannels(), static_cast<size_t>(fadeBuffer.getNumChannels()));
+
+    auto fadeBlock = juce::dsp::AudioBlock<float>(fadeBuffer).getSubsetChannelBlock(0, numChannels).getSubBlock(0, numSamples);
+    fadeBlock.copyFrom(block);
+
+    processChainSet(chainSets[activeChainSet], block, fadeOutSettings);
+    processChainSet(chainSets[1 - activeChainSet], fadeBlock, chainSettings);
+
+    const auto rampLength = juce::jmin(static_cast<int>(numSamples), fadeSamplesRemaining);
+    const auto startGain = fadeSamplesRemaining / (float)fadeLengthSamples; // of the outgoing set
+    const auto gainStep = -1.f / fadeLengthSamples;
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        auto* out = block.getChannelPointer(channel);
+        const auto* in = fadeBlock.getChannelPointer(channel);
+
+        auto gain = startGain;
+
+        for (int i = 0; i < rampLength; ++i)
+        {
+            out[i] = out[i] * gain + in[i] * (1.f - gain);
+            gain += gainStep;
+        }
+
+        // fade done part way through the block, the rest is all incoming
+        juce::FloatVectorOperations::copy(out + rampLength, in + rampLength, static_cast<int>(numSamples) - rampLength);
+    }
+
+    fadeSamplesRemaining -= rampLength;
+
+    if (fadeSamplesRemaining <= 0)
+        activeChainSet = 1 - activeChainSet; // back to a single set
+}
+
+void SimpleEQAudioProcessor::processChainSet(ChainSet& chainSet, juce::dsp::AudioBlock<float>& block, const ChainSettings& chainSettings)
+{
+    const auto numChannels = static_cast<int>(block.getNumChannels());
+
+    // Big blocks run one task per channel on the pool instead. A task is the channel's whole chain, so these
+    // get timed as one Parallel stage rather than per filter. The dynamic peak and the modulation redesign between pieces of the
+    // block for both channels at once, so those always stay on this thread.
+    if (channelPool != nullptr && !chainSettings.peakDynamic && !modulationActive && numChannels > 1
+        && (numChannels >= parallelMinChannels || static_cast<int>(block.getNumSamples()) >= parallelMinSamples))
+    {
+        auto processChannel = [&chainSet, &block](int channel)
+            {
+                auto channelBlock = block.getSingleChannelBlock(static_cast<size_t>(channel));
+                juce::dsp::ProcessContextReplacing<float> context(channelBlock);
+
+                (channel == 0 ? chainSet.leftChain : chainSet.rightChain).process(context);
+                chainSet.bandChain.processChannel(channelBlock.getChannelPointer(0), static_cast<int>(channelBlock.getNumSamples()), channel);
+            };
+
+        DspLoadMonitor::ScopedStage stage(dspLoadMonitor, DspLoadMonitor::Stage_Parallel);
+        (*channelPool)->pool.run(juce::jmin(numChannels, BandChain::maxChannels), processChannel);
+        return;
+    }
+
+    if (modulationActive)
+    {
+        processModulated(chainSet, block, chainSettings);
+        return;
+    }
+
+    auto& leftChain = chainSet.leftChain;
+    auto& rightChain = chainSet.rightChain;
 
     auto leftBlock = block.getSingleChannelBlock(0); // gets left channel
     auto rightBlock = block.getSingleChannelBlock(1); // gets right channel
@@ -178,108 +591,467 @@ void SimpleEQAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce
     juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock); // provides a wrapper around the block that the chain can process
     juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
 
-    leftChain.process(leftContext); // processes the channels
-    rightChain.process(rightContext);
+    // Stages run one at a time rather than through MonoChain::process so each can be timed
+    {
+        DspLoadMonitor::ScopedStage stage(dspLoadMonitor, DspLoadMonitor::Stage_LowCut);
+        leftChain.get<ChainPositions::LowCut>().process(leftContext);
+        rightChain.get<ChainPositions::LowCut>().process(rightContext);
+    }
 
+    {
+        DspLoadMonitor::ScopedStage stage(dspLoadMonitor, DspLoadMonitor::Stage_Peak);
+
+        if (chainSettings.peakDynamic)
+        {
+            processDynamicPeak(chainSet, block, chainSettings); // the peak gets fed in pieces
+        }
+        else
+        {
+            leftChain.get<ChainPositions::Peak>().process(leftContext);
+            rightChain.get<ChainPositions::Peak>().process(rightContext);
+        }
+    }
+
+    {
+        DspLoadMonitor::ScopedStage stage(dspLoadMonitor, DspLoadMonitor::Stage_HighCut);
+        leftChain.get<ChainPositions::HighCut>().process(leftContext);
+        rightChain.get<ChainPositions::HighCut>().process(rightContext);
+    }
+
+    DspLoadMonitor::ScopedStage bandsStage(dspLoadMonitor, DspLoadMonitor::Stage_Bands);
+    chainSet.bandChain.process(block); // only the enabled bands cost anything here
 }
 
-//==============================================================================
-bool SimpleEQAudioProcessor::hasEditor() const
+void SimpleEQAudioProcessor::processDynamicPeak(ChainSet& chainSet, juce::dsp::AudioBlock<float>& block, const ChainSettings& chainSettings)
 {
-    return true; // (change this to false if you choose to not supply an editor)
+    const auto sampleRate = getProcessingSampleRate();
+    const auto numSamples = block.getNumSamples();
+    const auto stepLength = static_cast<size_t>(DynamicPeak::controlInterval * oversamplingFactor.load());
+
+    auto& leftPeak = chainSet.leftChain.get<ChainPositions::Peak>();
+    auto& rightPeak = chainSet.rightChain.get<ChainPositions::Peak>();
+
+    const auto rightSettings = getChannelSettings(chainSettings, 1);
+    const bool linked = chainSettings.stereoMode == StereoMode::StereoMode_Linked;
+
+    // written straight into the existing coefficients, no allocation
+    auto makeCoefficients = [sampleRate](const ChainSettings& settings, float offset)
+        {
+            return juce::dsp::IIR::ArrayCoefficients<float>::makePeakFilter(
+                sampleRate,
+                settings.peakFreq,
+                settings.peakQuality,
+                juce::Decibels::decibelsToGain(juce::jmax(settings.peakGainInDecibels + offset, -48.f)));
+        };
+
+    for (size_t start = 0, step = 0; start < numSamples; start += stepLength, ++step)
+    {
+        const auto offset = dynamicPeak.getGainOffset(juce::jmin(static_cast<int>(step), dynamicPeak.getNumControlSteps() - 1));
+
+        const auto coefficients = makeCoefficients(chainSettings, offset);
+
+        *leftPeak.coefficients = coefficients;
+        *rightPeak.coefficients = linked ? coefficients : makeCoefficients(rightSettings, offset);
+
+        auto subBlock = block.getSubBlock(start, juce::jmin(stepLength, numSamples - start));
+        auto leftBlock = subBlock.getSingleChannelBlock(0);
+        auto rightBlock = subBlock.getSingleChannelBlock(1);
+
+        leftPeak.process(juce::dsp::ProcessContextReplacing<float>(leftBlock));
+        rightPeak.process(juce::dsp::ProcessContextReplacing<float>(rightBlock));
+    }
 }
 
-juce::AudioProcessorEditor* SimpleEQAudioProcessor::createEditor()
+Modulation::Transport SimpleEQAudioProcessor::getTransport()
 {
-    return new SimpleEQAudioProcessorEditor(*this);
-    return new juce::GenericAudioProcessorEditor(*this);
+    Modulation::Transport transport;
+
+    auto* playHead = getPlayHead();
+
+    if (playHead == nullptr)
+        return transport;
+
+   #if JUCE_MAJOR_VERSION >= 7
+    if (const auto position = playHead->getPosition())
+    {
+        if (const auto bpm = position->getBpm())
+            transport.bpm = *bpm;
+
+        if (const auto ppq = position->getPpqPosition())
+            transport.ppqPosition = *ppq;
+
+        transport.isPlaying = position->getIsPlaying();
+    }
+   #else
+    juce::AudioPlayHead::CurrentPositionInfo position;
+
+    if (playHead->getCurrentPosition(position))
+    {
+        transport.bpm = position.bpm;
+        transport.ppqPosition = position.ppqPosition;
+        transport.isPlaying = position.isPlaying;
+    }
+   #endif
+
+    if (transport.bpm <= 0)
+        transport.bpm = 120.0;
+
+    return transport;
 }
 
-//==============================================================================
-void SimpleEQAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
+void SimpleEQAudioProcessor::processModulated(ChainSet& chainSet, juce::dsp::AudioBlock<float>& block, const ChainSettings& chainSettings)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    const auto numSamples = block.getNumSamples();
+    const auto numChannels = juce::jmin(static_cast<int>(block.getNumChannels()), 2);
+    const auto numSteps = modulation.getNumControlSteps();
+    const auto stepLength = static_cast<size_t>(modulation.getCurrentControlInterval() * oversamplingFactor.load());
+
+    const bool linked = chainSettings.stereoMode == StereoMode::StereoMode_Linked;
+
+    {
+        DspLoadMonitor::ScopedStage stage(dspLoadMonitor, DspLoadMonitor::Stage_Coefficients);
+
+        // every step of the block designed up front, linked channels share channel 0's
+        modulation.design(0, chainSettings, getProcessingSampleRate());
+
+        if (!linked && numChannels > 1)
+            modulation.design(1, getChannelSettings(chainSettings, 1), getProcessingSampleRate());
+
+        numRejectedModulatedSections = modulation.getNumRejectedSections();
+    }
+
+    // the cuts and the peak take turns per step here, so all three get timed as the peak stage
+    {
+        DspLoadMonitor::ScopedStage stage(dspLoadMonitor, DspLoadMonitor::Stage_Peak);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto& chain = channel == 0 ? chainSet.leftChain : chainSet.rightChain;
+            const auto channelSettings = getChannelSettings(chainSettings, channel);
+            auto channelBlock = block.getSingleChannelBlock(static_cast<size_t>(channel));
+
+            for (size_t start = 0, step = 0; start < numSamples && numSteps > 0; start += stepLength, ++step)
+            {
+                const auto& coefficients = modulation.getStepCoefficients(linked ? 0 : channel, juce::jmin(static_cast<int>(step), numSteps - 1));
+
+                updateCutFilter(chain.get<ChainPositions::LowCut>(), coefficients.lowCut, static_cast<Slope>(channelSettings.lowCutSlope));
+                updateCoefficients(chain.get<ChainPositions::Peak>().coefficients, coefficients.peak);
+                updateCutFilter(chain.get<ChainPositions::HighCut>(), coefficients.highCut, static_cast<Slope>(channelSettings.highCutSlope));
+
+                auto subBlock = channelBlock.getSubBlock(start, juce::jmin(stepLength, numSamples - start));
+                chain.process(juce::dsp::ProcessContextReplacing<float>(subBlock));
+            }
+        }
+    }
+
+    DspLoadMonitor::ScopedStage bandsStage(dspLoadMonitor, DspLoadMonitor::Stage_Bands);
+    chainSet.bandChain.process(block);
 }
 
-void SimpleEQAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
+void SimpleEQAudioProcessor::updateOversampling(const ChainSettings& chainSettings)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    const int index = chainSettings.oversampling == OversamplingFactor::Oversampling_Off
+        ? -1
+        : chainSettings.oversamplingFilter * 3 + chainSettings.oversampling - 1;
+
+    if (index != activeOversamplerIndex)
+    {
+        activeOversamplerIndex = index;
+        activeOversampler = index < 0 ? nullptr : oversamplers[index].get();
+        oversamplingFactor = 1 << chainSettings.oversampling;
+
+        traceRecorder.record(TraceRecorder::Event_Oversampling, oversamplingFactor.load());
+
+        // the filter state belongs to the old rate, so start clean
+        for (auto& chainSet : chainSets)
+            chainSet.reset();
+
+        fadeSamplesRemaining = 0;
+
+        if (activeOversampler != nullptr)
+            activeOversampler->reset();
+    }
 }
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+void SimpleEQAudioProcessor::updateLatency()
 {
-    ChainSettings settings;
+    int latency = 0;
 
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
-    settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load();
-    settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
-    settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
-    settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load()); // need cast to satisfy compiler
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
-    settings.outputGainInDB = apvts.getRawParameterValue("Output Gain")->load();
+    if (activePhaseMode == PhaseMode::PhaseMode_Linear)
+        latency = linearPhaseEQ->getLatencyInSamples();
+    else if (activeOversampler != nullptr)
+        latency = juce::roundToInt(static_cast<float>(activeOversampler->getLatencyInSamples()));
 
-    return settings;
+    if (limiterActive)
+        latency += outputLimiter.getLatencyInSamples();
+
+    // setLatencySamples only tells the host when the value actually changes
+    setLatencySamples(latency);
 }
 
-void /*SimpleEQAudioProcessor::*/ updateCoefficients(Coefficients& old, const Coefficients& replacements)
+void SimpleEQAudioProcessor::updateLimiter(const ChainSettings& chainSettings)
 {
-    *old = *replacements;
+    // coming back on, the delay line still holds whatever was there when it was switched off
+    if (chainSettings.limiterEnabled && !limiterActive)
+        outputLimiter.reset();
+
+    limiterActive = chainSettings.limiterEnabled;
+
+    if (limiterActive)
+        outputLimiter.setParameters(chainSettings.limiterCeilingInDecibels, chainSettings.limiterLookaheadMs, chainSettings.limiterReleaseMs);
 }
 
-void SimpleEQAudioProcessor::updateLowCutFilters(const ChainSettings& chainSettings)
+void SimpleEQAudioProcessor::updatePhaseMode(const ChainSettings& chainSettings)
 {
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, getSampleRate()); // This is for filter, to find why, refer to tutorial, 1:00:00
+    if (chainSettings.phaseMode == activePhaseMode)
+        return;
 
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    updateCutFilter(leftLowCut, lowCutCoefficients, static_cast<Slope>(chainSettings.lowCutSlope));
+    activePhaseMode = chainSettings.phaseMode;
 
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
-    updateCutFilter(rightLowCut, lowCutCoefficients, static_cast<Slope>(chainSettings.lowCutSlope));
+    traceRecorder.record(TraceRecorder::Event_PhaseMode, activePhaseMode);
 
+    // whichever path is coming back in still holds state from before it was switched away
+    if (activePhaseMode == PhaseMode::PhaseMode_Linear)
+    {
+        linearPhaseEQ->reset();
+    }
+    else
+    {
+        for (auto& chainSet : chainSets)
+            chainSet.reset();
+
+        fadeSamplesRemaining = 0;
+
+        if (activeOversampler != nullptr)
+            activeOversampler->reset();
+    }
 }
 
-void SimpleEQAudioProcessor::updateHighCutFilters(const ChainSettings& chainSettings)
+//==============================================================================
+bool SimpleEQAudioProcessor::hasEditor() const
 {
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate()); // This is for filter, to find why, refer to tutorial, 1:00:00
+    return true; // (change this to false if you choose to not supply an editor)
+}
 
-    auto& lefthighCut = leftChain.get<ChainPositions::HighCut>();
-    updateCutFilter(lefthighCut, highCutCoefficients, static_cast<Slope>(chainSettings.highCutSlope));
+juce::AudioProcessorEditor* SimpleEQAudioProcessor::createEditor()
+{
+    return new SimpleEQAudioProcessorEditor(*this);
+    return new juce::GenericAudioProcessorEditor(*this);
+}
 
-    auto& righthighCut = rightChain.get<ChainPositions::HighCut>();
-    updateCutFilter(righthighCut, highCutCoefficients, static_cast<Slope>(chainSettings.highCutSlope));
+//==============================================================================
+// Binary state layout:
+//   int magic, int version, int number of parameters, then one float per parameter (plain value)
+//   in the order of getParameters(). New parameters only ever get appended to the layout, so an older
+//   state just has fewer values and the rest go back to their defaults.
+//   From version 2 on that's followed by int number of snapshots and the same list of floats per snapshot.
+// Anything without the magic is treated as the generic APVTS XML.
+namespace
+{
+    constexpr int stateMagic = 0x4251454b; // "KEQB"
+    constexpr int stateVersion = 2;
 }
 
-void SimpleEQAudioProcessor::updateFilters()
+void SimpleEQAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    auto chainSettings = getChainSettings(apvts);
+    const auto& params = getParameters();
+    const auto numParams = static_cast<size_t>(params.size());
 
-    updateLowCutFilters(chainSettings);
-    updatePeakFilter(chainSettings);
-    updateHighCutFilters(chainSettings);
-}
+    destData.ensureSize(sizeof(int) * 4 + sizeof(float) * numParams * (numSnapshots + 1));
 
+    juce::MemoryOutputStream stream(destData, false);
+
+    stream.writeInt(stateMagic);
+    stream.writeInt(stateVersion);
+    stream.writeInt(params.size());
+
+    for (auto* param : params)
+    {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(param))
+            stream.writeFloat(ranged->convertFrom0to1(ranged->getValue()));
+        else
+            stream.writeFloat(param->getValue());
+    }
+
+    stream.writeInt(numSnapshots);
+
+    for (int slot = 0; slot < numSnapshots; ++slot)
+    {
+        const auto values = coefficientDesigner->getSnapshotValues(slot);
+
+        for (int i = 0; i < params.size(); ++i)
+            stream.writeFloat(values[i]);
+    }
+}
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+void SimpleEQAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter( // this is here to ensure that the setting changes are being applied in real time
-        sampleRate,
-        chainSettings.peakFreq,
-        chainSettings.peakQuality,
-        juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+    juce::MemoryInputStream stream(data, static_cast<size_t>(sizeInBytes), false);
+
+    // Hold the designer off until everything is in, one redesign for the whole state instead of one per parameter
+    coefficientDesigner->beginBulkChange();
+
+    if (sizeInBytes >= (int)sizeof(int) * 3 && stream.readInt() == stateMagic)
+    {
+        const auto version = stream.readInt();
+        const auto& params = getParameters();
+
+        // The counts come from whatever the host hands back, so never more than the data could hold.
+        // A newer layout can have more parameters than we know about, those get read and skipped.
+        auto getNumFloatsLeft = [&] { return static_cast<int>(stream.getNumBytesRemaining() / static_cast<juce::int64>(sizeof(float))); };
+        const auto storedParamCount = stream.readInt();
+        const auto numStored = juce::jlimit(0, getNumFloatsLeft(), storedParamCount);
+
+        // one list of plain values, anything the state doesn't have goes back to its default
+        auto readValues = [&]()
+            {
+                juce::Array<float> values;
+
+                for (int i = 0; i < juce::jmax(numStored, params.size()); ++i)
+                {
+                    const bool stored = i < numStored && !stream.isExhausted();
+                    const auto value = stored ? stream.readFloat() : 0.f;
+
+                    if (i >= params.size())
+                        continue;
+
+                    auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(params[i]);
+
+                    if (stored)
+                        values.add(value);
+                    else
+                        values.add(ranged != nullptr ? ranged->convertFrom0to1(params[i]->getDefaultValue()) : params[i]->getDefaultValue());
+                }
+
+                return values;
+            };
+
+        const auto values = readValues();
+
+        for (int i = 0; i < params.size(); ++i)
+        {
+            auto* param = params[i];
+            auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(param);
+
+            const auto normalised = ranged != nullptr ? ranged->convertTo0to1(values[i]) : values[i];
+
+            // untouched parameters don't need to bother the host or the listeners
+            if (normalised != param->getValue())
+                param->setValueNotifyingHost(normalised);
+        }
+
+        if (version >= 2)
+        {
+            // slots past the ones we have are never used, and a slot needs numStored values to be there at all
+            const auto storedSnapshotCount = stream.readInt();
+            const auto numSlotsLeft = numStored > 0 ? getNumFloatsLeft() / numStored : numSnapshots;
+            const auto numStoredSnapshots = juce::jlimit(0, juce::jmin(numSnapshots, numSlotsLeft), storedSnapshotCount);
+
+            for (int slot = 0; slot < numStoredSnapshots; ++slot)
+                coefficientDesigner->setSnapshotValues(slot, readValues());
+        }
+
+        // the parameters above are the active slot, not a switch away from whatever was active before
+        coefficientDesigner->setActiveSnapshot(static_cast<int>(apvts.getRawParameterValue("Snapshot")->load()));
+    }
+    else if (auto xml = getXmlFromBinary(data, sizeInBytes))
+    {
+        if (xml->hasTagName(apvts.state.getType()))
+        {
+            apvts.replaceState(juce::ValueTree::fromXml(*xml));
+            coefficientDesigner->setActiveSnapshot(static_cast<int>(apvts.getRawParameterValue("Snapshot")->load()));
+        }
+    }
+
+    coefficientDesigner->endBulkChange();
 }
 
+// Shared by both getChainSettings versions, getValue hands back the plain value for a parameter ID
+template <typename ValueSource>
+static ChainSettings readChainSettings(ValueSource&& getValue)
+{
+    ChainSettings settings;
+
+    settings.lowCutFreq = getValue("LowCut Freq");
+    settings.highCutFreq = getValue("HighCut Freq");
+    settings.peakFreq = getValue("Peak Freq");
+    settings.peakGainInDecibels = getValue("Peak Gain");
+    settings.peakQuality = getValue("Peak Quality");
+    settings.lowCutSlope = static_cast<Slope>(getValue("LowCut Slope")); // need cast to satisfy compiler
+    settings.highCutSlope = static_cast<Slope>(getValue("HighCut Slope"));
+    settings.outputGainInDB = getValue("Output Gain");
+    settings.autoGain = getValue("Auto Gain") > 0.5f;
+    settings.oversampling = static_cast<OversamplingFactor>(getValue("Oversampling"));
+    settings.oversamplingFilter = static_cast<OversamplingFilter>(getValue("Oversampling Filter"));
+    settings.phaseMode = static_cast<PhaseMode>(getValue("Phase Mode"));
+
+    settings.stereoMode = static_cast<StereoMode>(getValue("Stereo Mode"));
+    settings.rightLowCutFreq = getValue("Right LowCut Freq");
+    settings.rightHighCutFreq = getValue("Right HighCut Freq");
+    settings.rightPeakFreq = getValue("Right Peak Freq");
+    settings.rightPeakGainInDecibels = getValue("Right Peak Gain");
+    settings.rightPeakQuality = getValue("Right Peak Quality");
+    settings.rightLowCutSlope = static_cast<Slope>(getValue("Right LowCut Slope"));
+    settings.rightHighCutSlope = static_cast<Slope>(getValue("Right HighCut Slope"));
+
+    settings.peakDynamic = getValue("Peak Dynamic") > 0.5f;
+    settings.peakSidechain = getValue("Peak Sidechain") > 0.5f;
+    settings.peakThresholdInDecibels = getValue("Peak Threshold");
+    settings.peakRatio = getValue("Peak Ratio");
+    settings.peakAttackMs = getValue("Peak Attack");
+    settings.peakReleaseMs = getValue("Peak Release");
+
+    settings.snapshot = static_cast<int>(getValue("Snapshot"));
+
+    settings.limiterEnabled = getValue("Limiter") > 0.5f;
+    settings.limiterCeilingInDecibels = getValue("Limiter Ceiling");
+    settings.limiterLookaheadMs = getValue("Limiter Lookahead");
+    settings.limiterReleaseMs = getValue("Limiter Release");
+
+    settings.modLfoRate = static_cast<int>(getValue("Mod LFO Rate"));
+    settings.modLfoShape = static_cast<int>(getValue("Mod LFO Shape"));
+    settings.modEnvAttackMs = getValue("Mod Env Attack");
+    settings.modEnvReleaseMs = getValue("Mod Env Release");
+    settings.modControlRate = static_cast<int>(getValue("Mod Control Rate"));
+
+    for (int target = 0; target < numModulationTargets; ++target)
+    {
+        const auto prefix = Modulation::getTargetName(target);
+
+        settings.modSource[static_cast<size_t>(target)] = static_cast<int>(getValue(prefix + " Mod Source"));
+        settings.modDepth[static_cast<size_t>(target)] = getValue(prefix + " Mod Depth");
+    }
 
+    for (int i = 0; i < numParametricBands; ++i)
+    {
+        const auto prefix = "Band " + juce::String(i + 1);
+        auto& band = settings.bands[i];
 
-void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings)
+        band.enabled = getValue(prefix + " On") > 0.5f;
+        band.type = static_cast<BandType>(getValue(prefix + " Type"));
+        band.freq = getValue(prefix + " Freq");
+        band.gainInDecibels = getValue(prefix + " Gain");
+        band.quality = getValue(prefix + " Quality");
+    }
+
+    return settings;
+}
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
 {
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+    return readChainSettings([&apvts](const juce::String& parameterID)
+        {
+            return apvts.getRawParameterValue(parameterID)->load();
+        });
+}
 
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, const juce::Array<float>& values)
+{
+    return readChainSettings([&apvts, &values](const juce::String& parameterID)
+        {
+            auto* param = apvts.getParameter(parameterID);
+            return values[param->getParameterIndex()]; // out of range just reads 0
+        });
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::createParameterLayout()
@@ -357,6 +1129,177 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::crea
             4.f),
         0.0f));
 
+    juce::StringArray oversamplingArray{ "Off", "2x", "4x", "8x" };
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling", "Oversampling", oversamplingArray, 0));
+
+    juce::StringArray oversamplingFilterArray{ "Min Phase IIR", "Linear Phase FIR" };
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling Filter", "Oversampling Filter", oversamplingFilterArray, 0));
+
+    juce::StringArray phaseModeArray{ "Minimum Phase", "Linear Phase" };
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Phase Mode", "Phase Mode", phaseModeArray, 0));
+
+    // Stereo mode, plus a second set of the main controls for right (or side) when it isn't linked
+    juce::StringArray stereoModeArray{ "Linked", "Independent L/R", "Mid/Side" };
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Stereo Mode", "Stereo Mode", stereoModeArray, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Right LowCut Freq",
+        "Right/Side LowCut Freq",
+        juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+        20.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Right HighCut Freq",
+        "Right/Side HighCut Freq",
+        juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+        20000.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Right Peak Freq",
+        "Right/Side Peak Freq",
+        juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+        750.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Right Peak Gain",
+        "Right/Side Peak Gain",
+        juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+        0.0f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Right Peak Quality",
+        "Right/Side Peak Quality",
+        juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
+        1.f));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Right LowCut Slope", "Right/Side LowCut Slope", stringArray, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Right HighCut Slope", "Right/Side HighCut Slope", stringArray, 0));
+
+    // Dynamic peak
+    layout.add(std::make_unique<juce::AudioParameterBool>("Peak Dynamic", "Peak Dynamic", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>("Peak Sidechain", "Peak Sidechain", false));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Peak Threshold",
+        "Peak Threshold",
+        juce::NormalisableRange<float>(-60.f, 0.f, 0.5f, 1.f),
+        -20.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Peak Ratio",
+        "Peak Ratio",
+        juce::NormalisableRange<float>(1.f, 20.f, 0.1f, 0.5f),
+        2.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Peak Attack",
+        "Peak Attack",
+        juce::NormalisableRange<float>(0.1f, 200.f, 0.1f, 0.4f),
+        10.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Peak Release",
+        "Peak Release",
+        juce::NormalisableRange<float>(5.f, 2000.f, 1.f, 0.4f),
+        100.f));
+
+    // Extra parametric bands, all off by default and spread out log wise across the spectrum
+    juce::StringArray bandTypeArray{ "Peak", "Low Shelf", "High Shelf", "Notch" };
+
+    for (int i = 0; i < numParametricBands; ++i)
+    {
+        const auto prefix = "Band " + juce::String(i + 1);
+        const auto defaultFreq = 20.f * std::pow(1000.f, (i + 0.5f) / numParametricBands);
+
+        layout.add(std::make_unique<juce::AudioParameterBool>(prefix + " On", prefix + " On", false));
+        layout.add(std::make_unique<juce::AudioParameterChoice>(prefix + " Type", prefix + " Type", bandTypeArray, 0));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            prefix + " Freq",
+            prefix + " Freq",
+            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+            std::round(defaultFreq)));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            prefix + " Gain",
+            prefix + " Gain",
+            juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+            0.0f));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            prefix + " Quality",
+            prefix + " Quality",
+            juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
+            1.f));
+    }
+
+    // Settings slots, switching between them crossfades (see CoefficientDesigner for how the slots are kept)
+    juce::StringArray snapshotArray{ "A", "B", "C", "D" };
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Snapshot", "Snapshot", snapshotArray, 0));
+
+    // Output limiter, off by default so existing sessions sound the same
+    layout.add(std::make_unique<juce::AudioParameterBool>("Limiter", "Limiter", false));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Limiter Ceiling",
+        "Limiter Ceiling",
+        juce::NormalisableRange<float>(-12.f, 0.f, 0.1f, 1.f),
+        -1.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Limiter Lookahead",
+        "Limiter Lookahead",
+        juce::NormalisableRange<float>(0.5f, OutputLimiter::maxLookaheadMs, 0.1f, 1.f),
+        1.5f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Limiter Release",
+        "Limiter Release",
+        juce::NormalisableRange<float>(10.f, 1000.f, 1.f, 0.4f),
+        100.f));
+
+    // Internal modulation of the main filters, every depth at 0 leaves the EQ exactly as it was
+    juce::StringArray lfoRateArray{ "1/16", "1/8", "1/4", "1/2", "1 Bar", "2 Bars", "4 Bars" };
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Mod LFO Rate", "Mod LFO Rate", lfoRateArray, 2));
+
+    juce::StringArray lfoShapeArray{ "Sine", "Triangle", "Saw", "Square" };
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Mod LFO Shape", "Mod LFO Shape", lfoShapeArray, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Mod Env Attack",
+        "Mod Env Attack",
+        juce::NormalisableRange<float>(0.1f, 100.f, 0.1f, 0.5f),
+        10.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Mod Env Release",
+        "Mod Env Release",
+        juce::NormalisableRange<float>(10.f, 2000.f, 1.f, 0.4f),
+        200.f));
+
+    // samples between coefficient updates, lower follows faster and costs more
+    juce::StringArray controlRateArray{ "16", "32", "64", "128" };
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Mod Control Rate", "Mod Control Rate", controlRateArray, 1));
+
+    juce::StringArray modSourceArray{ "Off", "LFO", "Envelope" };
+
+    for (int target = 0; target < numModulationTargets; ++target)
+    {
+        const auto prefix = Modulation::getTargetName(target);
+        const auto maxDepth = target == Modulation::Target_PeakGain ? 24.f : 4.f; // dB or octaves
+
+        layout.add(std::make_unique<juce::AudioParameterChoice>(prefix + " Mod Source", prefix + " Mod Source", modSourceArray, 0));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            prefix + " Mod Depth",
+            prefix + " Mod Depth",
+            juce::NormalisableRange<float>(-maxDepth, maxDepth, 0.01f, 1.f),
+            0.f));
+    }
+
+    // Level matches the EQ'd signal to the dry one (see CoefficientDesigner), for fair bypass comparisons
+    layout.add(std::make_unique<juce::AudioParameterBool>("Auto Gain", "Auto Gain", false));
+
     return layout;
 }
 
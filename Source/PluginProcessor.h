@@ -9,98 +9,25 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "EqChain.h"
+#include "DynamicPeak.h"
+#include "Modulation.h"
+#include "DspLoadMonitor.h"
+#include "TraceRecorder.h"
+#include "LoudnessMeter.h"
+#include "OutputLimiter.h"
 
-enum Slope // enums can be expressed as integers
-{
-    Slope_12,
-    Slope_24,
-    Slope_36,
-    Slope_48
-};
-
-struct ChainSettings {
-    float peakFreq{ 0 }, peakGainInDecibels{ 0 }, peakQuality{ 1.f };
-    float lowCutFreq{ 0 }, highCutFreq{ 0 };
-    int lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
-    float outputGainInDB{ 0 };
-};
-
-using Filter = juce::dsp::IIR::Filter<float>;
-
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>; // each filter can be instantiated with a specified x*12 db slope, so you need 4 for the high and low cuts
+constexpr int numSnapshots = 4; // A/B/C/D settings slots
 
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
-
-// Putting here for editing response curve
-using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
-
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
-
-
-template<int Index, typename ChainType, typename CoefficientType>
-void update(ChainType& chain, const CoefficientType& coefficients)
-{
-    updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-    chain.template setBypassed<Index>(false);
-}
-
-template<typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType& chain,
-    const CoefficientType& coefficients,
-    const Slope& slope)
-{
-    chain.template setBypassed<0>(true);
-    chain.template setBypassed<1>(true);
-    chain.template setBypassed<2>(true);
-    chain.template setBypassed<3>(true);
-
-    switch (slope)
-    {
-    case Slope_48:
-    {
-        update<3>(chain, coefficients);
-    }
-    case Slope_36:
-    {
-        update<2>(chain, coefficients);
-    }
-    case Slope_24:
-    {
-        update<1>(chain, coefficients);
-    }
-    case Slope_12:
-    {
-        update<0>(chain, coefficients);
-    }
-    }
-}
-
-
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(
-        chainSettings.lowCutFreq,
-        sampleRate,
-        2 * (chainSettings.lowCutSlope + 1));
-}
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
 
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(
-        chainSettings.highCutFreq,
-        sampleRate,
-        2 * (chainSettings.highCutSlope + 1));
-}
+// Same thing, but from a stored set of plain parameter values in getParameters() order (a snapshot slot)
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, const juce::Array<float>& values);
 
-enum ChainPositions
-{
-    LowCut,
-    Peak,
-    HighCut
-};
-
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+class LinearPhaseEQ;
+class CoefficientDesigner;
+class MatchEQ;
+struct SharedChannelPool;
 
 //==============================================================================
 /**
@@ -116,11 +43,15 @@ public:
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
 
+    // Clears every filter, delay line and envelope, keeps the coefficients, buffers and latency
+    void reset() override;
+
 #ifndef JucePlugin_PreferredChannelConfigurations
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
 #endif
 
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -149,20 +80,120 @@ public:
 
     juce::AudioProcessorValueTreeState apvts{ *this,nullptr,"Parameters",createParameterLayout() };
 
+    // Rate the filters are designed and run at, i.e. the host rate times the oversampling factor
+    double getProcessingSampleRate() const { return getSampleRate() * oversamplingFactor.load(); }
+
+    // Timing of processBlock per stage, safe to call from any thread
+    DspLoadMonitor::Snapshot getDspLoad() const { return dspLoadMonitor.getSnapshot(); }
+    void resetDspLoad() { dspLoadMonitor.resetStatistics(); }
+
+    // Event timeline of the audio thread, see TraceRecorder
+    TraceRecorder& getTraceRecorder() { return traceRecorder; }
+
+    // How many times a NaN/Inf in the output made the processor clear the block and reset its filters
+    int getNumOutputGuardResets() const { return numOutputGuardResets.load(); }
+
+    // Sections of the running coefficient set that couldn't be held in float and run flat instead,
+    // see ChainCoefficients::numRejectedSections, plus those of the last modulated block
+    int getNumRejectedSections() const { return numRejectedSections.load() + numRejectedModulatedSections.load(); }
+
+    // Loudness and true peak of the output, readable from any thread
+    LoudnessMeter& getLoudnessMeter() { return loudnessMeter; }
+    float getLimiterGainReductionInDecibels() const { return outputLimiter.getGainReductionInDecibels(); }
+
+    // Fits the EQ to a reference file, see MatchEQ
+    MatchEQ& getMatchEQ() { return *matchEQ; }
+
+    // Blocks with at least this many channels or samples (at the processing rate) get their channels
+    // split across the WorkStealingPool every instance shares, smaller ones never touch it. Takes effect
+    // from the next prepareToPlay.
+    void setParallelThresholds(int minChannels, int minSamples);
 
 private:
 
-    MonoChain leftChain, rightChain;
+    // Normally only chainSets[activeChainSet] runs, the other one only during a snapshot crossfade
+    std::array<ChainSet, 2> chainSets;
+    int activeChainSet = 0;
+
+    // Coefficients are designed off the audio thread and only copied in at block start
+    std::unique_ptr<CoefficientDesigner> coefficientDesigner;
+    ChainSettings currentSettings; // what the active chains are running
 
-    void updatePeakFilter(const ChainSettings& chainSettings);
+    void pickUpNewCoefficients();
 
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
+    // Snapshot switches crossfade from the active set to the other one
+    ChainSettings fadeOutSettings;
+    juce::AudioBuffer<float> fadeBuffer;
+    int fadeLengthSamples = 0, fadeSamplesRemaining = 0;
 
     float gainValue;
     float previousGain;
+    float autoGainInDecibels = 0; // from the coefficient set the chains are running
+
+    // One oversampler per factor and filter type, built in prepareToPlay so switching never allocates
+    // Indexed with [filter * 3 + factor - 1]
+    std::array<std::unique_ptr<juce::dsp::Oversampling<float>>, 6> oversamplers;
+    juce::dsp::Oversampling<float>* activeOversampler = nullptr;
+    int activeOversamplerIndex = -1;
+    std::atomic<int> oversamplingFactor{ 1 }; // read by the editor too
+
+    void updateOversampling(const ChainSettings& chainSettings);
+    void processChains(juce::dsp::AudioBlock<float>& block, const ChainSettings& chainSettings);
+    void processChainSet(ChainSet& chainSet, juce::dsp::AudioBlock<float>& block, const ChainSettings& chainSettings);
+
+    // What prepareToPlay last set everything up for. A repeat at the same rate and channel count with a
+    // block that still fits is just a reset, unless something asked for a full one.
+    double preparedSampleRate = 0;
+    int preparedBlockSize = 0, preparedNumChannels = 0;
+    bool needsFullPrepare = true;
+
+    // The oversamplers can outlive a full prepare, so they keep their own size
+    int oversamplerBlockSize = 0, oversamplerNumChannels = 0;
+
+    // only held if the thresholds can be reached with the oversampling prepareToPlay saw
+    std::unique_ptr<juce::SharedResourcePointer<SharedChannelPool>> channelPool;
+    int parallelMinChannels = 8, parallelMinSamples = 4096;
+
+    DynamicPeak dynamicPeak;
+
+    // Peak stage in control interval sized pieces, redesigning between them from the dynamic gain offsets
+    void processDynamicPeak(ChainSet& chainSet, juce::dsp::AudioBlock<float>& block, const ChainSettings& chainSettings);
+
+    Modulation modulation;
+    bool modulationActive = false; // this block, only on the IIR path
+
+    Modulation::Transport getTransport();
+
+    // Low cut, peak and high cut in control interval sized pieces from the modulation's per step coefficients,
+    // then the bands as usual. Takes over the dynamic peak too, its offsets are folded into the modulation's.
+    void processModulated(ChainSet& chainSet, juce::dsp::AudioBlock<float>& block, const ChainSettings& chainSettings);
+
+    std::unique_ptr<LinearPhaseEQ> linearPhaseEQ;
+    std::unique_ptr<MatchEQ> matchEQ;
+    int activePhaseMode = PhaseMode::PhaseMode_Minimum;
+
+    void updatePhaseMode(const ChainSettings& chainSettings);
+    void updateLatency();
+
+    DspLoadMonitor dspLoadMonitor;
+    TraceRecorder traceRecorder;
+
+    bool bypassed = false; // only for tracing the transitions
+
+    // Once a NaN gets into a filter's state it stays there, so anything non finite coming out
+    // silences the block and resets every bit of state so the next block starts clean
+    bool guardOutput(juce::AudioBuffer<float>& buffer);
+    void resetProcessingState();
+    std::atomic<int> numOutputGuardResets{ 0 };
+    std::atomic<int> numRejectedSections{ 0 };
+    std::atomic<int> numRejectedModulatedSections{ 0 };
+
+    LoudnessMeter loudnessMeter;
+
+    OutputLimiter outputLimiter;
+    bool limiterActive = false;
 
-    void updateFilters();
+    void updateLimiter(const ChainSettings& chainSettings);
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SimpleEQAudioProcessor)
@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    ResponseCurves.cpp
+
+  ==============================================================================
+*/
+
+#include "ResponseCurves.h"
+
+void ResponseCurves::setFrequencies(int numPoints, double newSampleRate)
+{
+    numPoints = juce::jmax(0, numPoints);
+
+    if (static_cast<int>(zInverse.size()) == numPoints && sampleRate == newSampleRate)
+        return;
+
+    sampleRate = newSampleRate;
+    zInverse.resize(static_cast<size_t>(numPoints));
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        const auto freq = juce::mapToLog10(double(i) / double(numPoints), 20.0, 20000.0);
+        zInverse[static_cast<size_t>(i)] = std::polar(1.0, -juce::MathConstants<double>::twoPi * freq / sampleRate);
+    }
+
+    for (auto& stage : stages)
+        stage.evaluated = false;
+
+    magnitudes.assign(zInverse.size(), 0.0);
+    phases.assign(zInverse.size(), 0.0);
+    groupDelays.assign(zInverse.size(), 0.0);
+
+    needsCombining = true;
+}
+
+void ResponseCurves::setChain(const ChainCoefficients& coefficients, int channel)
+{
+    const auto& sections = coefficients.channels[static_cast<size_t>(channel)];
+    const auto settings = getChannelSettings(coefficients.settings, channel);
+
+    setStage(Stage_LowCut, sections.lowCut.data(), settings.lowCutSlope + 1);
+    setStage(Stage_Peak, &sections.peak, 1);
+    setStage(Stage_HighCut, sections.highCut.data(), settings.highCutSlope + 1);
+
+    // the band chain packs the enabled ones to the front, back to one stage per band here
+    std::array<bool, numParametricBands> active{};
+
+    for (int slot = 0; slot < coefficients.bands.getNumActiveBands(); ++slot)
+    {
+        const auto band = coefficients.bands.getBandIndex(slot);
+        const auto biquad = coefficients.bands.getBiquad(slot);
+
+        active[static_cast<size_t>(band)] = true;
+        setStage(Stage_FirstBand + band, &biquad, 1);
+    }
+
+    for (int band = 0; band < numParametricBands; ++band)
+        if (!active[static_cast<size_t>(band)])
+            setStage(Stage_FirstBand + band, nullptr, 0);
+}
+
+void ResponseCurves::setStage(int index, const Biquad* sections, int numSections)
+{
+    auto& stage = stages[static_cast<size_t>(index)];
+
+    if (stage.numSections == numSections && std::equal(sections, sections + numSections, stage.sections.begin()))
+        return;
+
+    std::copy(sections, sections + numSections, stage.sections.begin());
+    stage.numSections = numSections;
+    stage.evaluated = false;
+    needsCombining = true;
+}
+
+void ResponseCurves::evaluate(StageCache& stage)
+{
+    const auto numPoints = zInverse.size();
+
+    stage.response.assign(numPoints, 1.0);
+    stage.delay.assign(numPoints, 0.0);
+    stage.evaluated = true;
+
+    for (int s = 0; s < stage.numSections; ++s)
+    {
+        const auto& section = stage.sections[static_cast<size_t>(s)];
+
+        for (size_t i = 0; i < numPoints; ++i)
+        {
+            double delay = 0;
+            stage.response[i] *= evaluateBiquad(section, zInverse[i], &delay);
+            stage.delay[i] += delay;
+        }
+    }
+}
+
+void ResponseCurves::update()
+{
+    if (!needsCombining)
+        return;
+
+    for (auto& stage : stages)
+        if (stage.numSections > 0 && !stage.evaluated)
+            evaluate(stage);
+
+    needsCombining = false;
+
+    const auto msPerSample = 1000.0 / sampleRate;
+
+    for (size_t i = 0; i < zInverse.size(); ++i)
+    {
+        std::complex<double> response = 1.0;
+        double delay = 0;
+
+        for (const auto& stage : stages)
+        {
+            if (stage.numSections == 0)
+                continue;
+
+            response *= stage.response[i];
+            delay += stage.delay[i];
+        }
+
+        magnitudes[i] = 10.0 * std::log10(juce::jmax(std::norm(response), 1.0e-30));
+        phases[i] = juce::radiansToDegrees(std::arg(response));
+        groupDelays[i] = delay * msPerSample;
+    }
+}
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    ResponseCurves.h
+
+    What the editor draws: magnitude, phase and group delay of the chain over
+    a log spaced frequency grid (one point per pixel). Each stage (low cut,
+    peak, high cut and every parametric band) keeps its own complex response
+    and group delay over the grid and only evaluates them again when its
+    coefficients change, both in the same pass over its sections. Combining
+    the stages is then one complex multiply and an add per stage and point.
+
+    Group delay is analytic rather than differentiated from the phase, see
+    evaluateBiquad.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "EqChain.h"
+
+class ResponseCurves
+{
+public:
+    enum Stage
+    {
+        Stage_LowCut,
+        Stage_Peak,
+        Stage_HighCut,
+        Stage_FirstBand,
+        numStages = Stage_FirstBand + numParametricBands
+    };
+
+    // Grid from 20 Hz to 20 kHz, everything gets evaluated again when it changes
+    void setFrequencies(int numPoints, double sampleRate);
+
+    // Stages from one channel of a designed set, only the ones that differ from last time get evaluated
+    void setChain(const ChainCoefficients& coefficients, int channel = 0);
+
+    // Combines the stages into the curves below if anything changed since last time
+    void update();
+
+    const std::vector<double>& getMagnitudes() const { return magnitudes; }   // dB
+    const std::vector<double>& getPhases() const { return phases; }           // degrees, -180...180
+    const std::vector<double>& getGroupDelays() const { return groupDelays; } // ms
+
+private:
+    using Biquad = ChainCoefficients::Biquad;
+
+    struct StageCache
+    {
+        std::array<Biquad, 4> sections{};
+        int numSections = 0; // none means it's flat and gets skipped
+
+        std::vector<std::complex<double>> response;
+        std::vector<double> delay; // samples
+        bool evaluated = false;
+    };
+
+    void setStage(int stage, const Biquad* sections, int numSections);
+    void evaluate(StageCache& stage);
+
+    double sampleRate = 44100.0;
+    std::vector<std::complex<double>> zInverse; // e^-jw per point
+
+    std::array<StageCache, numStages> stages;
+    bool needsCombining = true;
+
+    std::vector<double> magnitudes, phases, groupDelays;
+};
@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    ResponseEvaluator.cpp
+
+  ==============================================================================
+*/
+
+#include "ResponseEvaluator.h"
+
+void ResponseEvaluator::prepare(const std::vector<double>& frequencies, double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    zInverse.resize(frequencies.size());
+    power.assign(frequencies.size(), 1.0);
+
+    for (size_t i = 0; i < frequencies.size(); ++i)
+        zInverse[i] = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequencies[i] / sampleRate);
+}
+
+void ResponseEvaluator::addBiquad(const std::array<float, 6>& c)
+{
+    for (size_t i = 0; i < power.size(); ++i)
+        power[i] *= std::norm(evaluateBiquad(c, zInverse[i]));
+}
+
+void ResponseEvaluator::addBands(const BandChain& bands)
+{
+    for (int slot = 0; slot < bands.getNumActiveBands(); ++slot)
+        addBiquad(bands.getBiquad(slot));
+}
+
+void ResponseEvaluator::addChain(const ChainSettings& chainSettings)
+{
+    designChainCoefficients(coefficients, chainSettings, sampleRate);
+
+    const auto& channel = coefficients.channels[0];
+
+    addBiquad(channel.peak);
+
+    for (int section = 0; section <= chainSettings.lowCutSlope; ++section)
+        addBiquad(channel.lowCut[static_cast<size_t>(section)]);
+
+    for (int section = 0; section <= chainSettings.highCutSlope; ++section)
+        addBiquad(channel.highCut[static_cast<size_t>(section)]);
+
+    addBands(coefficients.bands);
+}
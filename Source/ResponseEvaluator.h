@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    ResponseEvaluator.h
+
+    Magnitude response of a whole chain over a fixed set of frequencies. The
+    e^-jw for every frequency are worked out once in prepare, after that each
+    biquad is one evaluateBiquad per point instead of the complex exp
+    getMagnitudeForFrequency does for every call. Meant for anything that
+    evaluates lots of candidate settings on the same grid.
+
+    Chains get designed by designChainCoefficients into a set that's reused,
+    so a candidate costs no allocation and is exactly what the processor
+    would run, clamps and pass through fallbacks included.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+class ResponseEvaluator
+{
+public:
+    void prepare(const std::vector<double>& frequencies, double sampleRate);
+
+    size_t size() const { return power.size(); }
+
+    // Back to a flat response
+    void clear() { std::fill(power.begin(), power.end(), 1.0); }
+
+    // b0, b1, b2, a0, a1, a2
+    void addBiquad(const std::array<float, 6>& c);
+    void addBands(const BandChain& bandChain);
+
+    // Low cut, peak, high cut and the extra bands of the first channel
+    void addChain(const ChainSettings& chainSettings);
+
+    double getDecibels(size_t index) const { return 10.0 * std::log10(juce::jmax(power[index], 1.0e-30)); }
+
+private:
+    double sampleRate = 44100.0;
+    std::vector<std::complex<double>> zInverse; // e^-jw per frequency
+    std::vector<double> power; // |H|^2 per frequency
+
+    ChainCoefficients coefficients; // scratch for designing the chains
+};
@@ -0,0 +1,157 @@
+/*
+  ==============================================================================
+
+    TraceRecorder.cpp
+
+  ==============================================================================
+*/
+
+#include "TraceRecorder.h"
+
+namespace
+{
+    std::atomic<int> nextInstanceId{ 1 };
+
+    const char* getEventName(int type)
+    {
+        switch (type)
+        {
+        case TraceRecorder::Event_BlockBegin:
+        case TraceRecorder::Event_BlockEnd: return "processBlock";
+        case TraceRecorder::Event_Coefficients: return "coefficients";
+        case TraceRecorder::Event_Snapshot: return "snapshot";
+        case TraceRecorder::Event_Bypass: return "bypass";
+        case TraceRecorder::Event_PhaseMode: return "phase mode";
+        case TraceRecorder::Event_Oversampling: return "oversampling";
+        case TraceRecorder::Event_OutputGuard: return "output guard";
+        default: return "unknown";
+        }
+    }
+}
+
+TraceRecorder::TraceRecorder()
+    : juce::Thread("KirbEqualizer trace"),
+      instanceId(nextInstanceId++)
+{
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    stop();
+}
+
+bool TraceRecorder::setOutputFile(const juce::File& file)
+{
+    stop();
+
+    file.deleteFile();
+    auto newStream = std::make_unique<juce::FileOutputStream>(file);
+
+    if (!newStream->openedOk())
+        return false;
+
+    stream = std::move(newStream);
+    firstEvent = true;
+
+    // Only allocated once tracing is actually used. It can't have been enabled before it exists, so the
+    // audio thread has never been in record() yet, and it's never reallocated after that.
+    if (events.empty())
+        events.resize(capacity);
+
+    // the JSON array format, which is allowed to stay open if we never get to close it
+    stream->writeText("[\n", false, false, nullptr);
+
+    // nothing is reading right now, so whatever piled up from before can just be skipped
+    readPosition.store(writePosition.load());
+
+    enabled.store(true, std::memory_order_release); // publishes events to record()
+    startThread();
+
+    return true;
+}
+
+void TraceRecorder::stop()
+{
+    if (!enabled.exchange(false) && stream == nullptr)
+        return;
+
+    stopThread(1000);
+
+    if (stream != nullptr)
+    {
+        drain();
+        stream->writeText("\n]\n", false, false, nullptr);
+        stream->flush();
+        stream.reset();
+    }
+}
+
+void TraceRecorder::startFromEnvironment()
+{
+    const auto path = juce::SystemStats::getEnvironmentVariable("KIRBEQ_TRACE", {});
+
+    if (path.isEmpty() || !juce::File::isAbsolutePath(path))
+        return;
+
+    auto file = juce::File(path);
+
+    if (file.isDirectory())
+        file = file.getChildFile("KirbEqualizer-" + juce::String(instanceId) + ".json").getNonexistentSibling();
+
+    setOutputFile(file);
+}
+
+void TraceRecorder::run()
+{
+    while (!threadShouldExit())
+    {
+        drain();
+        stream->flush();
+        wait(20);
+    }
+}
+
+void TraceRecorder::drain()
+{
+    const auto write = writePosition.load(std::memory_order_acquire);
+    auto read = readPosition.load(std::memory_order_relaxed);
+
+    for (; read != write; ++read)
+    {
+        const auto& event = events[read & (capacity - 1)];
+        writeEvent(event.type, event.ticks, event.threadId, event.value);
+    }
+
+    readPosition.store(read, std::memory_order_release);
+}
+
+void TraceRecorder::writeEvent(int type, juce::int64 ticks, juce::pointer_sized_int threadId, int value)
+{
+    // Chrome traces want microseconds, on Linux these are CLOCK_MONOTONIC so they line up with other tools
+    const auto microseconds = juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6;
+
+    juce::String phase = "i";
+
+    if (type == Event_BlockBegin)
+        phase = "B";
+    else if (type == Event_BlockEnd)
+        phase = "E";
+
+    juce::String line;
+    line << (firstEvent ? "" : ",\n")
+         << "{\"name\":\"" << getEventName(type) << "\",\"ph\":\"" << phase << "\""
+         << ",\"ts\":" << juce::String(microseconds, 3)
+         << ",\"pid\":" << instanceId
+         << ",\"tid\":" << juce::String((juce::int64)threadId);
+
+    if (phase == "i")
+        line << ",\"s\":\"t\"";
+
+    if (type != Event_BlockEnd)
+        line << ",\"args\":{\"value\":" << value << "}";
+
+    line << "}";
+
+    stream->writeText(line, false, false, nullptr);
+    firstEvent = false;
+}
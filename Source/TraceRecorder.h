@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    TraceRecorder.h
+
+    Timeline of what the audio thread did, for lining up our callbacks against
+    host xruns. processBlock pushes small fixed size events into a preallocated
+    single producer / single consumer ring, a background thread drains them into
+    a Chrome trace JSON file (which Perfetto and chrome://tracing both open).
+
+    Off unless a file is set, either with setOutputFile or by pointing the
+    KIRBEQ_TRACE environment variable at a file or directory.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class TraceRecorder : juce::Thread
+{
+public:
+    enum EventType
+    {
+        Event_BlockBegin,
+        Event_BlockEnd,
+        Event_Coefficients,   // a redesigned set was picked up, value is the snapshot it belongs to
+        Event_Snapshot,       // value is the new slot
+        Event_Bypass,         // value is 1 going into bypass, 0 coming out
+        Event_PhaseMode,      // value is the new PhaseMode
+        Event_Oversampling,   // value is the new factor
+        Event_OutputGuard,    // non finite output was caught and the filters reset, value is the channel
+        numEventTypes
+    };
+
+    TraceRecorder();
+    ~TraceRecorder() override;
+
+    // Message thread. Starts writing to the file, an existing one gets replaced
+    bool setOutputFile(const juce::File& file);
+    void stop();
+
+    // Picks up KIRBEQ_TRACE, a directory gets one file per instance
+    void startFromEnvironment();
+
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // Audio thread only. Never blocks, a full ring just drops the event and counts it
+    void record(EventType type, int value = 0)
+    {
+        // acquire, pairs with the release in setOutputFile so the ring allocated there is visible here
+        if (!enabled.load(std::memory_order_acquire))
+            return;
+
+        const auto write = writePosition.load(std::memory_order_relaxed);
+
+        if (write - readPosition.load(std::memory_order_acquire) >= capacity)
+        {
+            droppedEvents.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        auto& event = events[write & (capacity - 1)];
+        event.ticks = juce::Time::getHighResolutionTicks();
+        event.threadId = reinterpret_cast<juce::pointer_sized_int>(juce::Thread::getCurrentThreadId());
+        event.type = type;
+        event.value = value;
+
+        writePosition.store(write + 1, std::memory_order_release);
+    }
+
+    juce::uint64 getNumDroppedEvents() const { return droppedEvents.load(); }
+
+private:
+    void run() override;
+    void drain();
+    void writeEvent(int type, juce::int64 ticks, juce::pointer_sized_int threadId, int value);
+
+    struct Event
+    {
+        juce::int64 ticks;
+        juce::pointer_sized_int threadId;
+        int type;
+        int value;
+    };
+
+    static constexpr juce::uint64 capacity = 1 << 15; // power of two, about 1 MB
+
+    std::vector<Event> events; // empty until the first setOutputFile
+    std::atomic<juce::uint64> writePosition{ 0 }, readPosition{ 0 };
+    std::atomic<juce::uint64> droppedEvents{ 0 };
+    std::atomic<bool> enabled{ false };
+
+    // drain thread only (or the message thread while it's stopped)
+    std::unique_ptr<juce::FileOutputStream> stream;
+    bool firstEvent = true;
+
+    const int instanceId; // trace "pid", so several instances get their own rows
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TraceRecorder)
+};
@@ -0,0 +1,46 @@
+/*
+  ==============================================================================
+
+    TruePeakDetector.cpp
+
+  ==============================================================================
+*/
+
+#include "TruePeakDetector.h"
+
+void TruePeakDetector::prepare(int numChannels)
+{
+    // Hann windowed sinc with its cutoff at the original Nyquist, centred so phase 0 lands on an input sample
+    constexpr int numTaps = oversampling * tapsPerPhase;
+    constexpr double centre = numTaps / 2;
+
+    for (int phase = 0; phase < oversampling; ++phase)
+    {
+        float sum = 0;
+
+        for (int tap = 0; tap < tapsPerPhase; ++tap)
+        {
+            const auto n = tap * oversampling + phase;
+            const auto x = (n - centre) / oversampling;
+
+            const auto sinc = x == 0 ? 1.0 : std::sin(juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+            const auto window = 0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * n / numTaps);
+
+            phases[static_cast<size_t>(phase)][static_cast<size_t>(tap)] = static_cast<float>(sinc * window);
+            sum += phases[static_cast<size_t>(phase)][static_cast<size_t>(tap)];
+        }
+
+        // unity gain at DC for every phase, otherwise a steady signal would ripple
+        for (auto& coefficient : phases[static_cast<size_t>(phase)])
+            coefficient /= sum;
+    }
+
+    histories.assign(static_cast<size_t>(numChannels * 2 * tapsPerPhase), 0.f);
+    positions.assign(static_cast<size_t>(numChannels), 0);
+}
+
+void TruePeakDetector::reset()
+{
+    std::fill(histories.begin(), histories.end(), 0.f);
+    std::fill(positions.begin(), positions.end(), 0);
+}
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    TruePeakDetector.h
+
+    4x oversampled peak detection as in BS.1770. Each input sample is run
+    through a 48 tap windowed sinc interpolator split into four 12 tap phases,
+    and the largest absolute value of the four points is what comes out.
+    Phase 0 is the input itself (delayed), so the result is never below the
+    sample peak.
+
+    Shared by the loudness meter and the output limiter.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class TruePeakDetector
+{
+public:
+    static constexpr int oversampling = 4;
+    static constexpr int tapsPerPhase = 12;
+    static constexpr int latencyInSamples = tapsPerPhase / 2; // where phase 0 puts the input
+
+    void prepare(int numChannels);
+    void reset();
+
+    // Absolute true peak around the given sample, delayed by latencyInSamples
+    float processSample(int channel, float sample)
+    {
+        auto* history = histories.data() + channel * 2 * tapsPerPhase;
+        auto& position = positions[static_cast<size_t>(channel)];
+
+        // every sample is written twice so the taps can always be read in one straight run
+        position = position == 0 ? tapsPerPhase - 1 : position - 1;
+        history[position] = sample;
+        history[position + tapsPerPhase] = sample;
+
+        const auto* newestFirst = history + position;
+        float peak = 0;
+
+        for (const auto& phase : phases)
+        {
+            float sum = 0;
+
+            for (int tap = 0; tap < tapsPerPhase; ++tap)
+                sum += phase[static_cast<size_t>(tap)] * newestFirst[tap];
+
+            peak = juce::jmax(peak, std::abs(sum));
+        }
+
+        return peak;
+    }
+
+private:
+    std::array<std::array<float, tapsPerPhase>, oversampling> phases{};
+
+    std::vector<float> histories; // 2 * tapsPerPhase per channel
+    std::vector<int> positions;
+};
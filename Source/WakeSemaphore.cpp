@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    WakeSemaphore.cpp
+
+  ==============================================================================
+*/
+
+#include "WakeSemaphore.h"
+
+#if JUCE_WINDOWS
+ #include <windows.h>
+#elif JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#else
+ #include <semaphore.h>
+ #include <ctime>
+#endif
+
+#if JUCE_WINDOWS
+
+struct WakeSemaphore::Pimpl
+{
+    Pimpl() : handle(CreateSemaphoreW(nullptr, 0, 0x7fffffff, nullptr)) {}
+    ~Pimpl() { CloseHandle(handle); }
+
+    void post() { ReleaseSemaphore(handle, 1, nullptr); }
+    void wait(int timeoutMs) { WaitForSingleObject(handle, timeoutMs < 0 ? INFINITE : static_cast<DWORD>(timeoutMs)); }
+
+    HANDLE handle;
+};
+
+#elif JUCE_MAC || JUCE_IOS
+
+struct WakeSemaphore::Pimpl
+{
+    Pimpl() : semaphore(dispatch_semaphore_create(0)) {}
+    ~Pimpl() { dispatch_release(semaphore); }
+
+    void post() { dispatch_semaphore_signal(semaphore); }
+
+    void wait(int timeoutMs)
+    {
+        dispatch_semaphore_wait(semaphore, timeoutMs < 0 ? DISPATCH_TIME_FOREVER
+                                                         : dispatch_time(DISPATCH_TIME_NOW, static_cast<int64_t>(timeoutMs) * NSEC_PER_MSEC));
+    }
+
+    dispatch_semaphore_t semaphore;
+};
+
+#else
+
+struct WakeSemaphore::Pimpl
+{
+    Pimpl() { sem_init(&semaphore, 0, 0); }
+    ~Pimpl() { sem_destroy(&semaphore); }
+
+    void post() { sem_post(&semaphore); }
+
+    // EINTR or a timeout just return, the caller looks again either way
+    void wait(int timeoutMs)
+    {
+        if (timeoutMs < 0)
+        {
+            sem_wait(&semaphore);
+            return;
+        }
+
+        timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+
+        deadline.tv_sec += timeoutMs / 1000;
+        deadline.tv_nsec += (timeoutMs % 1000) * 1000000L;
+
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        sem_timedwait(&semaphore, &deadline);
+    }
+
+    sem_t semaphore;
+};
+
+#endif
+
+WakeSemaphore::WakeSemaphore() : pimpl(std::make_unique<Pimpl>()) {}
+WakeSemaphore::~WakeSemaphore() = default;
+
+void WakeSemaphore::post()
+{
+    pimpl->post();
+}
+
+void WakeSemaphore::wait(int timeoutMs)
+{
+    pimpl->wait(timeoutMs);
+}
@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    WakeSemaphore.h
+
+    Something a worker thread can sleep on that the audio thread is allowed
+    to wake. A WaitableEvent can't be used for that, signalling one locks a
+    mutex. This is the OS semaphore instead, posting it is an atomic
+    increment plus a kernel wake only when a thread is actually waiting.
+
+    It counts, so a post nobody was waiting for makes the next wait return
+    straight away. Whoever waits has to check for itself what woke it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class WakeSemaphore
+{
+public:
+    WakeSemaphore();
+    ~WakeSemaphore();
+
+    // Any thread, the audio thread included
+    void post();
+
+    // Returns after a post or the timeout, a negative timeout waits for as long as it takes
+    void wait(int timeoutMs = -1);
+
+private:
+    struct Pimpl;
+    std::unique_ptr<Pimpl> pimpl;
+
+    JUCE_DECLARE_NON_COPYABLE(WakeSemaphore)
+};
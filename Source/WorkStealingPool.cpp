@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+    WorkStealingPool.cpp
+
+  ==============================================================================
+*/
+
+#include "WorkStealingPool.h"
+#include "WakeSemaphore.h"
+#include <thread>
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+namespace
+{
+    constexpr juce::uint64 indexMask = 0xfffff;
+    constexpr juce::uint32 jobMask = 0xffffff;
+
+    // About as long as a couple of short blocks take, so back to back blocks find the workers awake
+    constexpr int spinLimit = 2000;
+
+    inline void relax()
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #else
+        std::this_thread::yield();
+       #endif
+    }
+}
+
+class WorkStealingPool::Worker : public juce::Thread
+{
+public:
+    Worker(WorkStealingPool& poolToUse, int laneToUse)
+        : juce::Thread("Work stealing worker " + juce::String(laneToUse)), pool(poolToUse), lane(laneToUse) {}
+
+    void run() override
+    {
+        // the tasks are filter chains too, their tails need flushing here the same as in processBlock
+        juce::ScopedNoDenormals noDenormals;
+
+        auto seen = pool.currentJob.load();
+        int spins = 0;
+
+        while (!threadShouldExit())
+        {
+            const auto job = pool.currentJob.load(std::memory_order_acquire);
+
+            if (job != seen)
+            {
+                seen = job;
+                spins = 0;
+                pool.work(job, lane);
+                continue;
+            }
+
+            if (++spins < spinLimit)
+            {
+                relax();
+                continue;
+            }
+
+            // parked has to be visible before the job is checked again, run() checks them the other way round.
+            // run() only posts when it's the one flipping it back, so a stale post or two can't pile up.
+            parked = true;
+
+            if (pool.currentJob.load() == seen)
+                wake.wait(100);
+
+            parked = false;
+            spins = 0;
+        }
+    }
+
+    std::atomic<bool> parked{ false };
+    WakeSemaphore wake;
+
+private:
+    WorkStealingPool& pool;
+    const int lane;
+};
+
+WorkStealingPool::WorkStealingPool(int numWorkers)
+{
+    const auto numCpus = juce::SystemStats::getNumCpus();
+    numWorkers = juce::jlimit(0, juce::jmax(0, numCpus - 1), numWorkers);
+
+    numLanes = numWorkers + 1; // lane 0 belongs to whoever calls run()
+    lanes.reset(new Lane[static_cast<size_t>(numLanes)]);
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        auto* worker = workers.add(new Worker(*this, i + 1));
+
+        // the caller spins on whatever a worker has started, so a worker can't be the one that gets preempted
+       #if JUCE_MAJOR_VERSION >= 7
+        worker->startRealtimeThread(juce::Thread::RealtimeOptions{}.withPriority(10));
+       #else
+        worker->startThread(10);
+       #endif
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    for (auto* worker : workers)
+    {
+        worker->signalThreadShouldExit();
+        worker->wake.post();
+    }
+
+    for (auto* worker : workers)
+        worker->stopThread(1000);
+}
+
+juce::uint64 WorkStealingPool::pack(juce::uint32 job, int next, int end)
+{
+    return (static_cast<juce::uint64>(job & jobMask) << 40)
+        | ((static_cast<juce::uint64>(next) & indexMask) << 20)
+        | (static_cast<juce::uint64>(end) & indexMask);
+}
+
+bool WorkStealingPool::claim(int lane, juce::uint32 job, int& index)
+{
+    auto& word = lanes[static_cast<size_t>(lane)].word;
+    auto current = word.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto next = static_cast<int>((current >> 20) & indexMask);
+        const auto end = static_cast<int>(current & indexMask);
+
+        if (static_cast<juce::uint32>(current >> 40) != job || next >= end)
+            return false;
+
+        if (word.compare_exchange_weak(current, pack(job, next + 1, end), std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            index = next;
+            return true;
+        }
+    }
+}
+
+void WorkStealingPool::work(juce::uint32 job, int ownLane)
+{
+    // If a newer job has replaced these by now, every claim below fails, so they're never run with the wrong lanes
+    const auto task = currentTask.load(std::memory_order_acquire);
+    auto* const context = currentContext.load(std::memory_order_acquire);
+
+    int index = 0;
+
+    for (int offset = 0; offset < numLanes; ++offset)
+    {
+        const auto lane = (ownLane + offset) % numLanes;
+
+        while (claim(lane, job, index))
+        {
+            task(context, index);
+            remaining.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+}
+
+void WorkStealingPool::run(int numTasks, Task task, void* context)
+{
+    jassert(numTasks <= maxTasks);
+
+    if (numTasks <= 0)
+        return;
+
+    if (workers.isEmpty() || numTasks == 1 || inUse.exchange(true, std::memory_order_acquire))
+    {
+        for (int i = 0; i < numTasks; ++i)
+            task(context, i);
+
+        return;
+    }
+
+    const auto job = (currentJob.load(std::memory_order_relaxed) + 1) & jobMask;
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        lanes[static_cast<size_t>(lane)].word.store(pack(job, numTasks * lane / numLanes, numTasks * (lane + 1) / numLanes));
+
+    currentTask.store(task);
+    currentContext.store(context);
+    remaining.store(numTasks);
+
+    currentJob.store(job);
+
+    for (auto* worker : workers)
+        if (worker->parked.exchange(false))
+            worker->wake.post();
+
+    work(job, 0);
+
+    // whatever's left is already running on a worker
+    while (remaining.load(std::memory_order_acquire) > 0)
+        relax();
+
+    inUse.store(false, std::memory_order_release);
+}
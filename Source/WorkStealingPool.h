@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    WorkStealingPool.h
+
+    A few persistent worker threads for splitting one block's work (a task per
+    channel group) across cores from the audio thread. run() hands every lane
+    (the workers plus the calling thread) an even share of the task indices,
+    whoever runs out first steals from the others' shares, and it returns once
+    everything is done. No allocation or locking on that path: each lane is a
+    single packed atomic word of { job, next, end } claimed with a CAS, so a
+    worker that's late from an older job can never take an index of a newer one.
+
+    Workers run at real time priority and spin for a little while after a job
+    in case the next block comes straight away, then park on a semaphore. They're
+    left to the scheduler rather than pinned, several pools pinned the same
+    way would all end up fighting over the same cores.
+
+    One thread at a time gets the workers. Anyone calling run() while another
+    thread has them just runs every task itself, so a pool can be shared (see
+    SharedChannelPool). The caller only ever waits for tasks a worker has
+    already started, anything not yet claimed it takes over.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class WorkStealingPool
+{
+public:
+    using Task = void (*)(void* context, int index);
+
+    explicit WorkStealingPool(int numWorkers);
+    ~WorkStealingPool();
+
+    int getNumWorkers() const { return workers.size(); }
+
+    // Runs task(context, i) for every i in [0, numTasks) and returns once they're all finished.
+    // The calling thread takes part, so with no workers (or none awake yet, or another thread
+    // in here already) it just does everything itself.
+    void run(int numTasks, Task task, void* context);
+
+    template<typename Callable>
+    void run(int numTasks, Callable& callable)
+    {
+        run(numTasks, [](void* context, int index) { (*static_cast<Callable*>(context))(index); }, &callable);
+    }
+
+private:
+    class Worker;
+
+    static constexpr int maxTasks = (1 << 20) - 1;
+
+    // { job:24, next:20, end:20 } in one word, on its own cache line so lanes don't fight over it
+    struct alignas(64) Lane
+    {
+        std::atomic<juce::uint64> word{ 0 };
+    };
+
+    static juce::uint64 pack(juce::uint32 job, int next, int end);
+
+    // Claims and runs indices, own lane first then the others, until none of them have any left for this job
+    void work(juce::uint32 job, int ownLane);
+    bool claim(int lane, juce::uint32 job, int& index);
+
+    std::unique_ptr<Lane[]> lanes;
+    int numLanes = 1;
+
+    std::atomic<juce::uint32> currentJob{ 0 };
+    std::atomic<Task> currentTask{ nullptr };
+    std::atomic<void*> currentContext{ nullptr };
+    std::atomic<int> remaining{ 0 };
+    std::atomic<bool> inUse{ false }; // some thread is in run() with the workers
+
+    juce::OwnedArray<Worker> workers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WorkStealingPool)
+};
+
+// The pool every processor in the process shares, held through a SharedResourcePointer so the
+// worker count doesn't grow with the instance count. One worker next to the calling thread is
+// as many lanes as the channel split has tasks (see BandChain::maxChannels).
+struct SharedChannelPool
+{
+    WorkStealingPool pool{ 1 };
+};
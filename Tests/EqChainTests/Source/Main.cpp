@@ -0,0 +1,784 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    Checks the filter designs on their own, no plugin involved: make*Filter,
+    updateCutFilter and designChainCoefficients against the analytic
+    Butterworth and cookbook peak responses, impulse responses against the
+    snapshots in Snapshots.h, and stability at the extremes of every
+    parameter. Returns non zero when anything fails.
+
+    EqChainTests [--update-snapshots]
+
+    --update-snapshots prints a new Snapshots.h instead of running the tests.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <complex>
+#include <iostream>
+#include <optional>
+
+#include "../../../Source/EqChain.h"
+#include "Snapshots.h"
+
+namespace
+{
+    constexpr double pi = juce::MathConstants<double>::pi;
+
+    using Biquad = ChainCoefficients::Biquad;
+    using Complex = std::complex<double>;
+
+    const std::array<double, 5> sampleRates{ 22050.0, 44100.0, 48000.0, 96000.0, 192000.0 };
+    const std::array<float, 11> designFrequencies{ 20.f, 50.f, 100.f, 200.f, 500.f, 1000.f, 2000.f, 5000.f, 10000.f, 15000.f, 20000.f };
+    const std::array<float, 5> qualities{ 0.1f, 0.71f, 1.f, 4.f, 10.f };
+    const std::array<float, 4> gains{ -24.f, -6.f, 6.f, 24.f };
+
+    // Same clamp designChainCoefficients applies
+    float clampToRate(float frequency, double sampleRate)
+    {
+        return juce::jmin(frequency, static_cast<float>(sampleRate * 0.49));
+    }
+
+    // 48 points per 1000:1, 20 Hz up to 20 kHz or just below Nyquist
+    std::vector<double> getEvaluationFrequencies(double sampleRate)
+    {
+        std::vector<double> frequencies;
+
+        for (int i = 0; i <= 48; ++i)
+        {
+            const auto frequency = 20.0 * std::pow(1000.0, i / 48.0);
+
+            if (frequency < sampleRate * 0.49)
+                frequencies.push_back(frequency);
+        }
+
+        return frequencies;
+    }
+
+    // Coefficients are float, and the further below the rate a design sits the closer its poles crowd
+    // z = 1 and the less of the response survives the rounding. Below 1/1000 of the rate (20 Hz at
+    // 44.1 kHz and up) it's off by whole dB, so those only get the stability checks.
+    struct Tolerance
+    {
+        double decibels, degrees;
+    };
+
+    std::optional<Tolerance> getTolerance(double frequency, double sampleRate)
+    {
+        const auto ratio = frequency / sampleRate;
+
+        if (ratio >= 5.0e-3)
+            return Tolerance{ 0.02, 0.25 };
+
+        if (ratio >= 1.0e-3)
+            return Tolerance{ 0.5, 8.0 };
+
+        return {};
+    }
+
+    // Butterworth through the bilinear transform: the analogue poles spread evenly over a circle of
+    // radius wc, evaluated at the prewarped frequency. Normalised to 1 in the pass band.
+    Complex getAnalyticCut(bool highPass, int order, double cutoff, double frequency, double sampleRate)
+    {
+        const Complex s(0.0, std::tan(pi * frequency / sampleRate));
+        const auto wc = std::tan(pi * cutoff / sampleRate);
+
+        Complex response = 1.0;
+
+        for (int k = 0; k < order; ++k)
+        {
+            const auto pole = std::polar(wc, pi * (2.0 * k + order + 1.0) / (2.0 * order));
+            response *= (highPass ? s : -pole) / (s - pole);
+        }
+
+        return response;
+    }
+
+    // The cookbook's analogue peak with s normalised to the centre, through the same transform
+    Complex getAnalyticPeak(double centre, double quality, double gain, double frequency, double sampleRate)
+    {
+        const auto A = std::sqrt(gain);
+        const Complex s(0.0, std::tan(pi * frequency / sampleRate) / std::tan(pi * centre / sampleRate));
+
+        return (s * s + s * (A / quality) + 1.0) / (s * s + s / (A * quality) + 1.0);
+    }
+
+    // Raw b0, b1, b2, a0, a1, a2 sections in series, in double
+    Complex evaluate(const Biquad* sections, int numSections, double frequency, double sampleRate)
+    {
+        const auto z = std::polar(1.0, -2.0 * pi * frequency / sampleRate); // z^-1
+        Complex response = 1.0;
+
+        for (int i = 0; i < numSections; ++i)
+        {
+            const auto& c = sections[i];
+            const double b0 = c[0], b1 = c[1], b2 = c[2], a0 = c[3], a1 = c[4], a2 = c[5];
+
+            response *= (b0 + z * (b1 + z * b2)) / (a0 + z * (a1 + z * a2));
+        }
+
+        return response;
+    }
+
+    // What the editor draws with, JUCE's own evaluation of the Coefficients objects
+    Complex evaluate(const juce::dsp::IIR::Coefficients<float>& coefficients, double frequency, double sampleRate)
+    {
+        return std::polar(coefficients.getMagnitudeForFrequency(frequency, sampleRate),
+            coefficients.getPhaseForFrequency(frequency, sampleRate));
+    }
+
+    Complex evaluate(const juce::ReferenceCountedArray<juce::dsp::IIR::Coefficients<float>>& sections, double frequency, double sampleRate)
+    {
+        Complex response = 1.0;
+
+        for (auto* section : sections)
+            response *= evaluate(*section, frequency, sampleRate);
+
+        return response;
+    }
+
+    // The normalised b0, b1, b2, a1, a2 a Coefficients object keeps, run directly in double (TDF II like IIR::Filter)
+    std::vector<double> getReferenceImpulseResponse(const juce::ReferenceCountedArray<juce::dsp::IIR::Coefficients<float>>& sections, int numSections, int length)
+    {
+        std::vector<double> samples(static_cast<size_t>(length), 0.0);
+        samples[0] = 1.0;
+
+        for (int i = 0; i < numSections; ++i)
+        {
+            const auto& c = sections[i]->coefficients;
+            double s1 = 0, s2 = 0;
+
+            for (auto& sample : samples)
+            {
+                const auto input = sample;
+                const auto output = c[0] * input + s1;
+
+                s1 = c[1] * input - c[3] * output + s2;
+                s2 = c[2] * input - c[4] * output;
+                sample = output;
+            }
+        }
+
+        return samples;
+    }
+
+    template<typename ProcessorType>
+    void processImpulse(ProcessorType& processor, float* samples, int length)
+    {
+        std::fill(samples, samples + length, 0.f);
+        samples[0] = 1.f;
+
+        float* channels[] = { samples };
+        juce::dsp::AudioBlock<float> block(channels, 1, static_cast<size_t>(length));
+        processor.process(juce::dsp::ProcessContextReplacing<float>(block));
+    }
+
+    ChainSettings makeSettings(float lowCutFreq, int lowCutSlope, float peakFreq, float peakQuality, float peakGainInDecibels,
+        float highCutFreq, int highCutSlope)
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = lowCutFreq;
+        settings.lowCutSlope = lowCutSlope;
+        settings.peakFreq = peakFreq;
+        settings.peakQuality = peakQuality;
+        settings.peakGainInDecibels = peakGainInDecibels;
+        settings.highCutFreq = highCutFreq;
+        settings.highCutSlope = highCutSlope;
+
+        return settings;
+    }
+
+    // Which part of the left chain a snapshot runs through
+    enum SnapshotStage
+    {
+        Stage_LowCut,
+        Stage_Peak,
+        Stage_HighCut,
+        Stage_Chain
+    };
+
+    struct SnapshotCase
+    {
+        const char* name;
+        double sampleRate;
+        int stage;
+        ChainSettings settings;
+    };
+
+    // Same order as impulseSnapshots
+    std::vector<SnapshotCase> getSnapshotCases()
+    {
+        return {
+            { "LowCut 100 Hz, 24 dB/oct, 48 kHz", 48000.0, Stage_LowCut, makeSettings(100.f, Slope_24, 1000.f, 1.f, 0.f, 20000.f, Slope_12) },
+            { "HighCut 5 kHz, 48 dB/oct, 44.1 kHz", 44100.0, Stage_HighCut, makeSettings(20.f, Slope_12, 1000.f, 1.f, 0.f, 5000.f, Slope_48) },
+            { "Peak 1 kHz, Q 2, +6 dB, 48 kHz", 48000.0, Stage_Peak, makeSettings(20.f, Slope_12, 1000.f, 2.f, 6.f, 20000.f, Slope_12) },
+            { "LowCut 80 Hz 12, Peak 2.5 kHz Q 0.7 -4 dB, HighCut 12 kHz 36, 96 kHz", 96000.0, Stage_Chain,
+                makeSettings(80.f, Slope_12, 2500.f, 0.7f, -4.f, 12000.f, Slope_36) }
+        };
+    }
+
+    // Through the same path the processor takes: designChainCoefficients, then applyChainCoefficients
+    std::array<float, snapshotLength> getImpulseResponse(const SnapshotCase& snapshotCase)
+    {
+        ChainCoefficients coefficients;
+        designChainCoefficients(coefficients, snapshotCase.settings, snapshotCase.sampleRate);
+
+        ChainSet chainSet;
+        chainSet.prepare({ snapshotCase.sampleRate, static_cast<juce::uint32>(snapshotLength), 1 });
+        applyChainCoefficients(coefficients, chainSet);
+
+        std::array<float, snapshotLength> samples{};
+        auto& chain = chainSet.leftChain;
+
+        switch (snapshotCase.stage)
+        {
+        case Stage_LowCut:  processImpulse(chain.get<ChainPositions::LowCut>(), samples.data(), snapshotLength); break;
+        case Stage_Peak:    processImpulse(chain.get<ChainPositions::Peak>(), samples.data(), snapshotLength); break;
+        case Stage_HighCut: processImpulse(chain.get<ChainPositions::HighCut>(), samples.data(), snapshotLength); break;
+        default:            processImpulse(chain, samples.data(), snapshotLength); break;
+        }
+
+        return samples;
+    }
+
+    // Every section a ChainCoefficients would run, bands included
+    std::vector<Biquad> getRunningSections(const ChainCoefficients& coefficients)
+    {
+        std::vector<Biquad> sections;
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            const auto settings = getChannelSettings(coefficients.settings, channel);
+            const auto& channelCoefficients = coefficients.channels[static_cast<size_t>(channel)];
+
+            sections.insert(sections.end(), channelCoefficients.lowCut.begin(), channelCoefficients.lowCut.begin() + settings.lowCutSlope + 1);
+            sections.insert(sections.end(), channelCoefficients.highCut.begin(), channelCoefficients.highCut.begin() + settings.highCutSlope + 1);
+            sections.push_back(channelCoefficients.peak);
+        }
+
+        for (int slot = 0; slot < coefficients.bands.getNumActiveBands(); ++slot)
+            sections.push_back(coefficients.bands.getBiquad(slot));
+
+        return sections;
+    }
+
+    // One of each band type, all at the same place
+    BandSettingsArray makeBands(float frequency, float quality, float gainInDecibels)
+    {
+        BandSettingsArray bands;
+
+        for (int type = Band_Peak; type <= Band_Notch; ++type)
+            bands[static_cast<size_t>(type)] = { true, type, frequency, gainInDecibels, quality };
+
+        return bands;
+    }
+
+    //==============================================================================
+    class DesignTest : public juce::UnitTest
+    {
+    public:
+        using juce::UnitTest::UnitTest;
+
+    protected:
+        // Magnitude everywhere the analytic response is above -40 dB (below that it's all rounding),
+        // phase at the same points
+        template<typename Designed, typename Analytic>
+        void expectResponse(Designed&& designed, Analytic&& analytic, double designFrequency, double sampleRate, const juce::String& description)
+        {
+            const auto tolerance = getTolerance(designFrequency, sampleRate);
+
+            if (!tolerance.has_value())
+                return;
+
+            for (auto frequency : getEvaluationFrequencies(sampleRate))
+            {
+                const auto expected = analytic(frequency);
+                const auto expectedDecibels = juce::Decibels::gainToDecibels(std::abs(expected), -300.0);
+
+                if (expectedDecibels < -40.0)
+                    continue;
+
+                const auto actual = designed(frequency);
+                const auto where = description + " at " + juce::String(frequency, 1) + " Hz, " + juce::String(sampleRate) + " Hz rate";
+
+                expectWithinAbsoluteError(juce::Decibels::gainToDecibels(std::abs(actual), -300.0), expectedDecibels, tolerance->decibels, where + " (dB)");
+                expectWithinAbsoluteError(juce::radiansToDegrees(std::arg(actual / expected)), 0.0, tolerance->degrees, where + " (degrees)");
+            }
+        }
+    };
+
+    //==============================================================================
+    class CutDesignTests : public DesignTest
+    {
+    public:
+        CutDesignTests() : DesignTest("Cut designs", "EqChain") {}
+
+        void runTest() override
+        {
+            beginTest("makeLowCutFilter and makeHighCutFilter match the analytic Butterworth response");
+
+            for (auto sampleRate : sampleRates)
+                for (auto designFrequency : designFrequencies)
+                    for (int slope = Slope_12; slope <= Slope_48; ++slope)
+                    {
+                        const auto frequency = clampToRate(designFrequency, sampleRate);
+                        const auto order = 2 * (slope + 1);
+                        const auto settings = makeSettings(frequency, slope, 1000.f, 1.f, 0.f, frequency, slope);
+
+                        const auto lowCut = makeLowCutFilter(settings, sampleRate);
+                        const auto highCut = makeHighCutFilter(settings, sampleRate);
+
+                        expectEquals(lowCut.size(), slope + 1);
+                        expectEquals(highCut.size(), slope + 1);
+
+                        const auto description = juce::String(frequency) + " Hz order " + juce::String(order);
+
+                        expectResponse([&](double f) { return evaluate(lowCut, f, sampleRate); },
+                            [&](double f) { return getAnalyticCut(true, order, frequency, f, sampleRate); },
+                            frequency, sampleRate, "makeLowCutFilter " + description);
+
+                        expectResponse([&](double f) { return evaluate(highCut, f, sampleRate); },
+                            [&](double f) { return getAnalyticCut(false, order, frequency, f, sampleRate); },
+                            frequency, sampleRate, "makeHighCutFilter " + description);
+                    }
+
+            beginTest("designChainCoefficients cuts match the analytic Butterworth response");
+
+            for (auto sampleRate : sampleRates)
+                for (auto designFrequency : designFrequencies)
+                    for (int slope = Slope_12; slope <= Slope_48; ++slope)
+                    {
+                        const auto frequency = clampToRate(designFrequency, sampleRate);
+                        const auto order = 2 * (slope + 1);
+
+                        ChainCoefficients coefficients;
+                        designChainCoefficients(coefficients, makeSettings(designFrequency, slope, 1000.f, 1.f, 0.f, designFrequency, slope), sampleRate);
+
+                        const auto& left = coefficients.channels[0];
+                        const auto description = juce::String(frequency) + " Hz order " + juce::String(order);
+
+                        expectResponse([&](double f) { return evaluate(left.lowCut.data(), slope + 1, f, sampleRate); },
+                            [&](double f) { return getAnalyticCut(true, order, frequency, f, sampleRate); },
+                            frequency, sampleRate, "designed low cut " + description);
+
+                        expectResponse([&](double f) { return evaluate(left.highCut.data(), slope + 1, f, sampleRate); },
+                            [&](double f) { return getAnalyticCut(false, order, frequency, f, sampleRate); },
+                            frequency, sampleRate, "designed high cut " + description);
+                    }
+
+            beginTest("Independent settings land in the right channel");
+            {
+                auto settings = makeSettings(100.f, Slope_12, 1000.f, 1.f, 0.f, 10000.f, Slope_12);
+                settings.stereoMode = StereoMode_Independent;
+                settings.rightLowCutFreq = 400.f;
+                settings.rightLowCutSlope = Slope_36;
+                settings.rightHighCutFreq = 4000.f;
+                settings.rightHighCutSlope = Slope_24;
+
+                ChainCoefficients coefficients;
+                designChainCoefficients(coefficients, settings, 48000.0);
+
+                const auto& right = coefficients.channels[1];
+
+                expectResponse([&](double f) { return evaluate(right.lowCut.data(), Slope_36 + 1, f, 48000.0); },
+                    [&](double f) { return getAnalyticCut(true, 8, 400.0, f, 48000.0); },
+                    400.0, 48000.0, "right low cut");
+
+                expectResponse([&](double f) { return evaluate(right.highCut.data(), Slope_24 + 1, f, 48000.0); },
+                    [&](double f) { return getAnalyticCut(false, 4, 4000.0, f, 48000.0); },
+                    4000.0, 48000.0, "right high cut");
+            }
+        }
+    };
+
+    //==============================================================================
+    class PeakDesignTests : public DesignTest
+    {
+    public:
+        PeakDesignTests() : DesignTest("Peak designs", "EqChain") {}
+
+        void runTest() override
+        {
+            beginTest("makePeakFilter, designChainCoefficients and the peak band match the cookbook response");
+
+            for (auto sampleRate : sampleRates)
+                for (auto designFrequency : designFrequencies)
+                    for (auto quality : qualities)
+                        for (auto gainInDecibels : gains)
+                        {
+                            const auto frequency = clampToRate(designFrequency, sampleRate);
+                            const auto gain = static_cast<double>(juce::Decibels::decibelsToGain(gainInDecibels));
+                            auto settings = makeSettings(20.f, Slope_12, frequency, quality, gainInDecibels, 20000.f, Slope_12);
+
+                            BandSettingsArray bands;
+                            bands[0] = { true, Band_Peak, frequency, gainInDecibels, quality };
+                            settings.bands = bands;
+
+                            const auto peak = makePeakFilter(settings, sampleRate);
+
+                            ChainCoefficients coefficients;
+                            designChainCoefficients(coefficients, settings, sampleRate);
+
+                            expectEquals(coefficients.bands.getNumActiveBands(), 1);
+
+                            const auto band = coefficients.bands.getBiquad(0);
+                            const auto description = juce::String(frequency) + " Hz, Q " + juce::String(quality) + ", " + juce::String(gainInDecibels) + " dB";
+
+                            auto analytic = [&](double f) { return getAnalyticPeak(frequency, quality, gain, f, sampleRate); };
+
+                            expectResponse([&](double f) { return evaluate(*peak, f, sampleRate); }, analytic,
+                                frequency, sampleRate, "makePeakFilter " + description);
+
+                            expectResponse([&](double f) { return evaluate(&coefficients.channels[0].peak, 1, f, sampleRate); }, analytic,
+                                frequency, sampleRate, "designed peak " + description);
+
+                            expectResponse([&](double f) { return evaluate(&band, 1, f, sampleRate); }, analytic,
+                                frequency, sampleRate, "peak band " + description);
+                        }
+        }
+    };
+
+    //==============================================================================
+    class UpdateCutFilterTests : public juce::UnitTest
+    {
+    public:
+        UpdateCutFilterTests() : juce::UnitTest("updateCutFilter", "EqChain") {}
+
+        void runTest() override
+        {
+            constexpr double sampleRate = 48000.0;
+            constexpr int length = 256;
+
+            // up and down through the slopes, so a section that was on has to get switched off again
+            const std::array<int, 8> slopes{ Slope_48, Slope_12, Slope_36, Slope_24, Slope_48, Slope_24, Slope_12, Slope_36 };
+
+            CutFilter fromObjects, fromArrays;
+            fromObjects.prepare({ sampleRate, static_cast<juce::uint32>(length), 1 });
+            fromArrays.prepare({ sampleRate, static_cast<juce::uint32>(length), 1 });
+
+            std::array<float, length> objectOutput{}, arrayOutput{};
+
+            beginTest("Only the first slope + 1 sections run, and they run the designed response");
+
+            for (auto slope : slopes)
+            {
+                const auto settings = makeSettings(200.f, slope, 1000.f, 1.f, 0.f, 20000.f, Slope_12);
+                const auto sections = makeLowCutFilter(settings, sampleRate);
+
+                ChainCoefficients coefficients;
+                designChainCoefficients(coefficients, settings, sampleRate);
+
+                updateCutFilter(fromObjects, sections, static_cast<Slope>(slope));
+                updateCutFilter(fromArrays, coefficients.channels[0].lowCut, static_cast<Slope>(slope));
+
+                for (auto* chain : { &fromObjects, &fromArrays })
+                {
+                    expect(!chain->isBypassed<0>(), "slope " + juce::String(slope) + " section 0");
+                    expect(chain->isBypassed<1>() == (slope < Slope_24), "slope " + juce::String(slope) + " section 1");
+                    expect(chain->isBypassed<2>() == (slope < Slope_36), "slope " + juce::String(slope) + " section 2");
+                    expect(chain->isBypassed<3>() == (slope < Slope_48), "slope " + juce::String(slope) + " section 3");
+                }
+
+                fromObjects.reset();
+                fromArrays.reset();
+
+                processImpulse(fromObjects, objectOutput.data(), length);
+                processImpulse(fromArrays, arrayOutput.data(), length);
+
+                const auto reference = getReferenceImpulseResponse(sections, slope + 1, length);
+
+                for (int i = 0; i < length; ++i)
+                {
+                    expectWithinAbsoluteError(static_cast<double>(objectOutput[static_cast<size_t>(i)]), reference[static_cast<size_t>(i)], 1.0e-5,
+                        "coefficient objects, slope " + juce::String(slope) + " sample " + juce::String(i));
+                    expectWithinAbsoluteError(static_cast<double>(arrayOutput[static_cast<size_t>(i)]), reference[static_cast<size_t>(i)], 1.0e-5,
+                        "coefficient arrays, slope " + juce::String(slope) + " sample " + juce::String(i));
+                }
+            }
+        }
+    };
+
+    //==============================================================================
+    class SnapshotTests : public juce::UnitTest
+    {
+    public:
+        SnapshotTests() : juce::UnitTest("Impulse response snapshots", "EqChain") {}
+
+        void runTest() override
+        {
+            const auto cases = getSnapshotCases();
+
+            beginTest("Every case has a snapshot");
+            expectEquals(static_cast<int>(cases.size()), static_cast<int>(impulseSnapshots.size()));
+
+            // float against double processing of the same coefficients differs by a few 1e-6
+            for (size_t i = 0; i < juce::jmin(cases.size(), impulseSnapshots.size()); ++i)
+            {
+                beginTest(cases[i].name);
+
+                const auto samples = getImpulseResponse(cases[i]);
+
+                for (int n = 0; n < snapshotLength; ++n)
+                    expectWithinAbsoluteError(samples[static_cast<size_t>(n)], impulseSnapshots[i][static_cast<size_t>(n)], 2.0e-5f,
+                        "sample " + juce::String(n));
+            }
+        }
+    };
+
+    //==============================================================================
+    class StabilityTests : public juce::UnitTest
+    {
+    public:
+        StabilityTests() : juce::UnitTest("Stability", "EqChain") {}
+
+        void runTest() override
+        {
+            constexpr auto inf = std::numeric_limits<float>::infinity();
+            constexpr auto nan = std::numeric_limits<float>::quiet_NaN();
+
+            beginTest("isStableBiquad");
+
+            expect(isStableBiquad(passThroughBiquad));
+            expect(isStableBiquad({ 1.f, 0.f, 0.f, 1.f, -1.9f, 0.95f }));
+            expect(!isStableBiquad({ 1.f, 0.f, 0.f, 1.f, 0.f, 1.f }), "poles on the unit circle");
+            expect(!isStableBiquad({ 1.f, 0.f, 0.f, 1.f, -2.f, 1.f }), "double pole at z = 1");
+            expect(!isStableBiquad({ 1.f, 0.f, 0.f, 1.f, -2.1f, 1.1f }), "poles outside");
+            expect(!isStableBiquad({ 1.f, 0.f, 0.f, 2.f, -3.8f, 1.9f }), "poles outside once normalised");
+            expect(!isStableBiquad({ 1.f, 0.f, 0.f, 0.f, 0.f, 0.f }), "a0 of 0");
+            expect(!isStableBiquad({ nan, 0.f, 0.f, 1.f, 0.f, 0.f }), "NaN");
+            expect(!isStableBiquad({ 1.f, 0.f, 0.f, 1.f, inf, 0.f }), "infinity");
+
+            beginTest("Nothing gets rejected at the extremes, up to 48 kHz with the bands and 96 kHz without");
+
+            for (auto sampleRate : { 22050.0, 44100.0, 48000.0, 88200.0, 96000.0 })
+                for (auto frequency : { 20.f, 20000.f })
+                    for (auto quality : { 0.1f, 10.f })
+                        for (auto gainInDecibels : { -24.f, 24.f })
+                            for (int slope = Slope_12; slope <= Slope_48; ++slope)
+                            {
+                                auto settings = makeSettings(frequency, slope, frequency, quality, gainInDecibels, frequency, slope);
+
+                                // the shelves only have a few ulp to spare at 20 Hz, 88.2 kHz
+                                if (sampleRate <= 48000.0)
+                                    settings.bands = makeBands(frequency, quality, gainInDecibels);
+
+                                ChainCoefficients coefficients;
+                                designChainCoefficients(coefficients, settings, sampleRate);
+
+                                expectEquals(coefficients.numRejectedSections, 0,
+                                    juce::String(frequency) + " Hz, Q " + juce::String(quality) + ", " + juce::String(gainInDecibels)
+                                    + " dB, slope " + juce::String(slope) + " at " + juce::String(sampleRate) + " Hz");
+                            }
+
+            beginTest("Above that, whatever float can't hold is counted and never runs");
+
+            for (auto sampleRate : { 176400.0, 192000.0, 352800.0, 384000.0, 768000.0 })
+                for (auto gainInDecibels : { -24.f, 24.f })
+                    for (int slope = Slope_12; slope <= Slope_48; ++slope)
+                    {
+                        auto settings = makeSettings(20.f, slope, 20.f, 10.f, gainInDecibels, 20.f, slope);
+                        settings.bands = makeBands(20.f, 10.f, gainInDecibels);
+
+                        ChainCoefficients coefficients;
+                        designChainCoefficients(coefficients, settings, sampleRate);
+
+                        const auto where = juce::String(gainInDecibels) + " dB, slope " + juce::String(slope) + " at " + juce::String(sampleRate) + " Hz";
+
+                        for (const auto& section : getRunningSections(coefficients))
+                            expect(isStableBiquad(section), "unstable section runs, " + where);
+
+                        // at 16x of 48 kHz nothing at 20 Hz survives, which has to show up in the count
+                        if (sampleRate >= 768000.0)
+                            expectGreaterThan(coefficients.numRejectedSections, 0, where);
+                    }
+
+            beginTest("A rate of 0 designs a flat set");
+            {
+                ChainCoefficients coefficients;
+                designChainCoefficients(coefficients, makeSettings(20.f, Slope_48, 1000.f, 1.f, 6.f, 20000.f, Slope_48), 0.0);
+
+                expectEquals(coefficients.numRejectedSections, 0);
+                expectEquals(coefficients.bands.getNumActiveBands(), 0);
+
+                for (const auto& section : getRunningSections(coefficients))
+                    expect(section == passThroughBiquad);
+            }
+
+            beginTest("Extreme settings decay to silence without denormals");
+
+            for (auto sampleRate : { 44100.0, 48000.0 })
+                for (auto frequency : { 20.f, 20000.f })
+                    for (auto quality : { 0.1f, 10.f })
+                        for (auto gainInDecibels : { -24.f, 24.f })
+                            expectDecays(makeSettings(frequency, Slope_48, frequency, quality, gainInDecibels, frequency, Slope_48), frequency, quality, gainInDecibels, sampleRate);
+        }
+
+    private:
+        struct TailResult
+        {
+            int numNonFinite = 0;
+            int numNonZeroInLastSecond = 0; // subnormal or not, once the state is cut off it's all exact zeros
+            float tail = 0;                 // loudest sample of the last block
+        };
+
+        // An impulse and then 10 s of silence through the whole chain set, in blocks like the processor
+        TailResult runTail(const ChainCoefficients& coefficients, double sampleRate)
+        {
+            constexpr int blockSize = 512;
+
+            ChainSet chainSet;
+            chainSet.prepare({ sampleRate, static_cast<juce::uint32>(blockSize), 1 });
+            applyChainCoefficients(coefficients, chainSet);
+
+            std::array<float, blockSize> samples{};
+            float* channels[] = { samples.data() };
+            juce::dsp::AudioBlock<float> block(channels, 1, blockSize);
+
+            const auto numBlocks = static_cast<int>(10.0 * sampleRate) / blockSize;
+            const auto firstBlockOfLastSecond = numBlocks - static_cast<int>(sampleRate) / blockSize;
+
+            TailResult result;
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                samples.fill(0.f);
+                samples[0] = i == 0 ? 1.f : 0.f;
+
+                chainSet.leftChain.process(juce::dsp::ProcessContextReplacing<float>(block));
+                chainSet.bandChain.processChannel(samples.data(), blockSize, 0);
+
+                result.tail = 0;
+
+                for (auto sample : samples)
+                {
+                    result.numNonFinite += std::isfinite(sample) ? 0 : 1;
+                    result.numNonZeroInLastSecond += i >= firstBlockOfLastSecond && sample != 0.f ? 1 : 0;
+                    result.tail = juce::jmax(result.tail, std::abs(sample));
+                }
+            }
+
+            return result;
+        }
+
+        // With denormals flushed like the processor does, the tail has to stay finite and die away. Without
+        // flushing (EqCore's callers, anything else's threads) the filters' state has to get cut off at a
+        // block boundary rather than crawl through the subnormal range, which is where the CPU slows right
+        // down. Only Intel does either of those, elsewhere the cut off is a no op and subnormals cost nothing.
+        void expectDecays(ChainSettings settings, float frequency, float quality, float gainInDecibels, double sampleRate)
+        {
+            settings.bands = makeBands(frequency, quality, gainInDecibels);
+
+            ChainCoefficients coefficients;
+            designChainCoefficients(coefficients, settings, sampleRate);
+
+            const auto where = juce::String(frequency) + " Hz, Q " + juce::String(quality) + ", " + juce::String(gainInDecibels) + " dB at " + juce::String(sampleRate) + " Hz";
+
+            {
+                juce::ScopedNoDenormals noDenormals;
+                const auto flushed = runTail(coefficients, sampleRate);
+
+                expectEquals(flushed.numNonFinite, 0, "non finite output, " + where);
+                expectLessThan(flushed.tail, 1.0e-5f, "still ringing after 10 s, " + where);
+            }
+
+           #if JUCE_INTEL
+            const auto unflushed = runTail(coefficients, sampleRate);
+            expectEquals(unflushed.numNonZeroInLastSecond, 0, "state left in the subnormal range without flushing, " + where);
+           #endif
+        }
+    };
+
+    CutDesignTests cutDesignTests;
+    PeakDesignTests peakDesignTests;
+    UpdateCutFilterTests updateCutFilterTests;
+    SnapshotTests snapshotTests;
+    StabilityTests stabilityTests;
+
+    //==============================================================================
+    // %.9g round trips a float, with a .0 added where it would otherwise read as an int
+    juce::String formatFloat(float value)
+    {
+        auto text = juce::String::formatted("%.9g", static_cast<double>(value));
+
+        if (!text.containsAnyOf(".eEn"))
+            text << ".0";
+
+        return text + "f";
+    }
+
+    void printSnapshots()
+    {
+        const auto cases = getSnapshotCases();
+
+        std::cout << "/*\n"
+                     "  ==============================================================================\n"
+                     "\n"
+                     "    Snapshots.h\n"
+                     "\n"
+                     "    Impulse responses the designs are held to, the first snapshotLength\n"
+                     "    samples of each case in Main.cpp's getSnapshotCases(), in the same order.\n"
+                     "    After a deliberate change to the designs, regenerate it with\n"
+                     "    EqChainTests --update-snapshots > Snapshots.h\n"
+                     "\n"
+                     "  ==============================================================================\n"
+                     "*/\n"
+                     "\n"
+                     "#pragma once\n"
+                     "\n"
+                     "#include <array>\n"
+                     "\n"
+                     "constexpr int snapshotLength = " << snapshotLength << ";\n"
+                     "\n"
+                     "constexpr std::array<std::array<float, snapshotLength>, " << cases.size() << "> impulseSnapshots\n"
+                     "{ {\n";
+
+        for (size_t i = 0; i < cases.size(); ++i)
+        {
+            const auto samples = getImpulseResponse(cases[i]);
+
+            std::cout << "    // " << cases[i].name << "\n    { {\n";
+
+            for (int n = 0; n < snapshotLength; n += 4)
+            {
+                juce::StringArray row;
+
+                for (int k = n; k < n + 4; ++k)
+                    row.add(formatFloat(samples[static_cast<size_t>(k)]));
+
+                std::cout << "        " << row.joinIntoString(", ") << (n + 4 < snapshotLength ? ",\n" : "\n");
+            }
+
+            std::cout << (i + 1 < cases.size() ? "    } },\n" : "    } }\n");
+        }
+
+        std::cout << "} };" << std::endl;
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--update-snapshots"))
+    {
+        printSnapshots();
+        return 0;
+    }
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("EqChain");
+
+    int numFailures = 0;
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        numFailures += runner.getResult(i)->failures;
+
+    std::cout << (numFailures == 0 ? juce::String("All tests passed") : juce::String(numFailures) + " failures") << std::endl;
+
+    return numFailures == 0 ? 0 : 1;
+}
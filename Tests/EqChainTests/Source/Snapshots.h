@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    Snapshots.h
+
+    Impulse responses the designs are held to, the first snapshotLength
+    samples of each case in Main.cpp's getSnapshotCases(), in the same order.
+    After a deliberate change to the designs, regenerate it with
+    EqChainTests --update-snapshots > Snapshots.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+
+constexpr int snapshotLength = 64;
+
+constexpr std::array<std::array<float, snapshotLength>, 4> impulseSnapshots
+{ {
+    // LowCut 100 Hz, 24 dB/oct, 48 kHz
+    { {
+        0.983042435f, -0.033625513f, -0.03304919f, -0.0324786717f,
+        -0.0319139285f, -0.0313549311f, -0.0308016501f, -0.030254056f,
+        -0.0297121194f, -0.029175811f, -0.0286451014f, -0.028119961f,
+        -0.0276003605f, -0.0270862706f, -0.0265776617f, -0.0260745045f,
+        -0.0255767697f, -0.0250844277f, -0.0245974492f, -0.0241158047f,
+        -0.023639465f, -0.0231684006f, -0.022702582f, -0.02224198f,
+        -0.0217865651f, -0.0213363079f, -0.0208911791f, -0.0204511492f,
+        -0.0200161889f, -0.0195862688f, -0.0191613596f, -0.0187414317f,
+        -0.018326456f, -0.017916403f, -0.0175112434f, -0.0171109477f,
+        -0.0167154868f, -0.0163248311f, -0.0159389514f, -0.0155578184f,
+        -0.0151814027f, -0.0148096749f, -0.0144426059f, -0.0140801662f,
+        -0.0137223265f, -0.0133690577f, -0.0130203304f, -0.0126761153f,
+        -0.0123363831f, -0.0120011047f, -0.0116702508f, -0.011343792f,
+        -0.0110216994f, -0.0107039435f, -0.0103904952f, -0.0100813255f,
+        -0.00977640496f, -0.00947570459f, -0.00917919522f, -0.00888684775f,
+        -0.00859863306f, -0.00831452207f, -0.00803448573f, -0.00775849498f
+    } },
+    // HighCut 5 kHz, 48 dB/oct, 44.1 kHz
+    { {
+        5.61536094e-05f, 0.000693823214f, 0.00409928291f, 0.0154801296f,
+        0.042133923f, 0.0882948048f, 0.148283144f, 0.20427933f,
+        0.232748024f, 0.216666617f, 0.155815314f, 0.0684815462f,
+        -0.0164907627f, -0.0726775398f, -0.0871139485f, -0.0642133629f,
+        -0.0215836608f, 0.0192238459f, 0.0421237766f, 0.0419189825f,
+        0.0241184735f, 0.000309502378f, -0.0180447445f, -0.0244104576f,
+        -0.0188416709f, -0.00646821957f, 0.00584300456f, 0.0128192524f,
+        0.0126797357f, 0.00710721094f, -0.00026132201f, -0.00584240082f,
+        -0.00763631303f, -0.00572909402f, -0.00178260724f, 0.0020388016f,
+        0.00411514871f, 0.00394598476f, 0.0021126859f, -0.000217195893f,
+        -0.00192618083f, -0.00241752181f, -0.00175476357f, -0.000484923895f,
+        0.000706858294f, 0.00132411814f, 0.00123054102f, 0.000627290569f,
+        -0.000110111348f, -0.000633217499f, -0.000764842791f, -0.000536757829f,
+        -0.000128717992f, 0.00024255272f, 0.000425213487f, 0.000383130894f,
+        0.000185293611f, -4.77256332e-05f, -0.00020745016f, -0.00024155746f,
+        -0.00016374814f, -3.29018628e-05f, 8.25410326e-05f, 0.000136265529f
+    } },
+    // Peak 1 kHz, Q 2, +6 dB, 48 kHz
+    { {
+        1.02247286f, 0.0435550215f, 0.0404839791f, 0.036874577f,
+        0.0328114903f, 0.0283831575f, 0.0236801315f, 0.0187934698f,
+        0.0138131889f, 0.00882680598f, 0.00391798785f, -0.000834674103f,
+        -0.0053587492f, -0.00958890053f, -0.0134676573f, -0.0169460207f,
+        -0.0199839008f, -0.0225503848f, -0.0246238392f, -0.0261918529f,
+        -0.0272510282f, -0.0278066307f, -0.0278721096f, -0.0274685035f,
+        -0.026623746f, -0.0253718869f, -0.0237522465f, -0.0218085201f,
+        -0.0195878499f, -0.0171398806f, -0.0145158163f, -0.0117674937f,
+        -0.00894648662f, -0.00610325555f, -0.00328635372f, -0.000541701467f,
+        0.00208806293f, 0.00456414805f, 0.00685208442f, 0.00892210571f,
+        0.0107494342f, 0.0123144699f, 0.0136028845f, 0.0146056228f,
+        0.0153188163f, 0.0157436133f, 0.0158859334f, 0.0157561531f,
+        0.0153687306f, 0.0147417803f, 0.0138966039f, 0.0128571911f,
+        0.0116496964f, 0.0103019043f, 0.00884269074f, 0.00730149105f,
+        0.00570778244f, 0.00409058906f, 0.00247801712f, 0.000896826262f,
+        -0.000627957134f, -0.00207338021f, -0.00341885385f, -0.00464639029f
+    } },
+    // LowCut 80 Hz 12, Peak 2.5 kHz Q 0.7 -4 dB, HighCut 12 kHz 36, 96 kHz
+    { {
+        0.000998357721f, 0.00887136115f, 0.0366482451f, 0.0938524788f,
+        0.167179779f, 0.218530509f, 0.211125443f, 0.139377822f,
+        0.0344364047f, -0.0565962893f, -0.0989549821f, -0.086599465f,
+        -0.0396145612f, 0.0114986755f, 0.0429950904f, 0.0472370732f,
+        0.0316028685f, 0.0104260583f, -0.00403678338f, -0.00688244014f,
+        -0.000623988672f, 0.00839966851f, 0.0143782658f, 0.0147670808f,
+        0.01055613f, 0.0047029589f, 7.31006557e-05f, -0.00193983975f,
+        -0.00164133678f, -0.00035411737f, 0.000554304198f, 0.000363776703f,
+        -0.000842227792f, -0.00246748157f, -0.00385837483f, -0.00464721996f,
+        -0.0048480206f, -0.00473375673f, -0.00462345918f, -0.00471234916f,
+        -0.00501577552f, -0.00541946366f, -0.00577827589f, -0.00599955525f,
+        -0.00607454496f, -0.00605838848f, -0.00602452406f, -0.00602398311f,
+        -0.00606823605f, -0.00613680262f, -0.00619820543f, -0.00622977277f,
+        -0.00622685092f, -0.00620015099f, -0.0061662246f, -0.00613791952f,
+        -0.00611955596f, -0.0061077593f, -0.00609579399f, -0.00607817597f,
+        -0.00605319939f, -0.00602277718f, -0.00599051022f, -0.00595949345f
+    } }
+} };
@@ -0,0 +1,296 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    Stand in host for capacity planning. Loads the built plugin through the
+    regular plugin hosting code (no audio device), then runs 1...N instances
+    on a simulated real time callback schedule spread over some worker threads
+    and reports the largest instance count that never missed a deadline.
+
+    HostBenchmark --plugin path/to/KirbEqualizer.vst3
+                  [--instances 64] [--threads 4] [--rate 48000] [--block 256]
+                  [--seconds 5] [--load 1.0]
+
+    --load is how much of each period the callback is allowed to take before
+    it counts as a miss, e.g. 0.7 to leave the host some headroom.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+
+#if JUCE_LINUX
+ #include <unistd.h>
+#endif
+
+namespace
+{
+    struct Options
+    {
+        juce::String pluginPath;
+        int maxInstances = 64;
+        int numThreads = 4;
+        double sampleRate = 48000;
+        int blockSize = 256;
+        double seconds = 5;
+        double load = 1.0;
+    };
+
+    // Resident set size of the whole process, only known on Linux
+    juce::int64 getResidentBytes()
+    {
+       #if JUCE_LINUX
+        juce::StringArray fields;
+        fields.addTokens(juce::File("/proc/self/statm").loadFileAsString(), " ", {});
+
+        if (fields.size() > 1)
+            return fields[1].getLargeIntValue() * static_cast<juce::int64>(sysconf(_SC_PAGESIZE));
+       #endif
+
+        return 0;
+    }
+
+    struct Instance
+    {
+        std::unique_ptr<juce::AudioPluginInstance> plugin;
+        juce::AudioBuffer<float> buffer;
+        juce::MidiBuffer midi;
+    };
+
+    // One of these stands in for each of the host's audio threads
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(int index, const juce::AudioBuffer<float>& inputToUse)
+            : juce::Thread("Benchmark worker " + juce::String(index)), input(inputToUse) {}
+
+        std::vector<Instance*> instances;
+        juce::WaitableEvent startCycle, cycleDone;
+
+        void run() override
+        {
+            while (!threadShouldExit())
+            {
+                if (!startCycle.wait(100))
+                    continue;
+
+                for (auto* instance : instances)
+                {
+                    // fresh input every cycle like a host would hand over, otherwise the signal just decays
+                    for (int channel = 0; channel < instance->buffer.getNumChannels(); ++channel)
+                        instance->buffer.copyFrom(channel, 0, input, channel % input.getNumChannels(), 0, instance->buffer.getNumSamples());
+
+                    instance->midi.clear();
+                    instance->plugin->processBlock(instance->buffer, instance->midi);
+                }
+
+                cycleDone.signal();
+            }
+        }
+
+    private:
+        const juce::AudioBuffer<float>& input;
+    };
+
+    struct Result
+    {
+        int numCycles = 0, deadlineMisses = 0;
+        double meanCycleMs = 0, worstCycleMs = 0;
+    };
+
+    Result runSchedule(const std::vector<std::unique_ptr<Instance>>& instances,
+        juce::OwnedArray<Worker>& workers,
+        const Options& options)
+    {
+        for (auto* worker : workers)
+            worker->instances.clear();
+
+        for (size_t i = 0; i < instances.size(); ++i)
+            workers[static_cast<int>(i) % workers.size()]->instances.push_back(instances[i].get());
+
+        const auto periodMs = 1000.0 * options.blockSize / options.sampleRate;
+        const auto budgetMs = periodMs * options.load;
+
+        Result result;
+        result.numCycles = juce::jmax(1, juce::roundToInt(options.seconds * 1000.0 / periodMs));
+
+        double totalMs = 0;
+        auto cycleStart = juce::Time::getMillisecondCounterHiRes();
+
+        for (int cycle = 0; cycle < result.numCycles; ++cycle)
+        {
+            for (auto* worker : workers)
+                worker->startCycle.signal();
+
+            for (auto* worker : workers)
+                worker->cycleDone.wait();
+
+            const auto now = juce::Time::getMillisecondCounterHiRes();
+            const auto cycleMs = now - cycleStart;
+
+            totalMs += cycleMs;
+            result.worstCycleMs = juce::jmax(result.worstCycleMs, cycleMs);
+
+            if (cycleMs > budgetMs)
+                ++result.deadlineMisses;
+
+            // sleep until the next callback is due, a late one starts straight away like a device would
+            const auto nextCycle = cycleStart + periodMs;
+
+            while (juce::Time::getMillisecondCounterHiRes() < nextCycle - 1.5)
+                juce::Thread::sleep(1);
+
+            while (juce::Time::getMillisecondCounterHiRes() < nextCycle)
+                juce::Thread::yield();
+
+            cycleStart = juce::jmax(nextCycle, now);
+        }
+
+        result.meanCycleMs = totalMs / result.numCycles;
+        return result;
+    }
+
+    std::unique_ptr<Instance> createInstance(juce::AudioPluginFormatManager& formatManager,
+        const juce::PluginDescription& description,
+        const Options& options,
+        juce::String& error)
+    {
+        auto instance = std::make_unique<Instance>();
+        instance->plugin = formatManager.createPluginInstance(description, options.sampleRate, options.blockSize, error);
+
+        if (instance->plugin == nullptr)
+            return {};
+
+        auto& plugin = *instance->plugin;
+        plugin.setRateAndBufferSizeDetails(options.sampleRate, options.blockSize);
+        plugin.prepareToPlay(options.sampleRate, options.blockSize);
+
+        const auto numChannels = juce::jmax(plugin.getTotalNumInputChannels(), plugin.getTotalNumOutputChannels());
+        instance->buffer.setSize(numChannels, options.blockSize);
+        instance->midi.ensureSize(256);
+
+        return instance;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; // plugin hosting wants a message manager around
+
+    juce::ArgumentList args(argc, argv);
+    Options options;
+
+    options.pluginPath = args.getValueForOption("--plugin");
+
+    if (options.pluginPath.isEmpty())
+    {
+        std::cout << "Usage: HostBenchmark --plugin <path> [--instances N] [--threads N] [--rate Hz]"
+                     " [--block samples] [--seconds S] [--load fraction]" << std::endl;
+        return 1;
+    }
+
+    if (args.containsOption("--instances")) options.maxInstances = juce::jmax(1, args.getValueForOption("--instances").getIntValue());
+    if (args.containsOption("--threads")) options.numThreads = juce::jmax(1, args.getValueForOption("--threads").getIntValue());
+    if (args.containsOption("--rate")) options.sampleRate = args.getValueForOption("--rate").getDoubleValue();
+    if (args.containsOption("--block")) options.blockSize = juce::jmax(1, args.getValueForOption("--block").getIntValue());
+    if (args.containsOption("--seconds")) options.seconds = args.getValueForOption("--seconds").getDoubleValue();
+    if (args.containsOption("--load")) options.load = args.getValueForOption("--load").getDoubleValue();
+
+    juce::AudioPluginFormatManager formatManager;
+    formatManager.addDefaultFormats();
+
+    juce::OwnedArray<juce::PluginDescription> descriptions;
+
+    for (auto* format : formatManager.getFormats())
+        format->findAllTypesForFile(descriptions, options.pluginPath);
+
+    if (descriptions.isEmpty())
+    {
+        std::cout << "No plugin found in " << options.pluginPath << std::endl;
+        return 1;
+    }
+
+    const auto& description = *descriptions.getFirst();
+    std::cout << "Hosting " << description.name << " (" << description.pluginFormatName << ") at "
+              << options.sampleRate << " Hz, " << options.blockSize << " samples, "
+              << options.numThreads << " threads" << std::endl;
+
+    // white noise, the same for every instance
+    juce::AudioBuffer<float> input(2, options.blockSize);
+    juce::Random random;
+
+    for (int channel = 0; channel < input.getNumChannels(); ++channel)
+        for (int i = 0; i < input.getNumSamples(); ++i)
+            input.setSample(channel, i, random.nextFloat() * 0.5f - 0.25f);
+
+    juce::OwnedArray<Worker> workers;
+
+    for (int i = 0; i < options.numThreads; ++i)
+    {
+        workers.add(new Worker(i, input));
+        workers.getLast()->startThread();
+    }
+
+    // loaded once and thrown away, so the module itself and the plugin's statics don't count per instance
+    {
+        juce::String error;
+        createInstance(formatManager, description, options, error);
+    }
+
+    const auto baselineBytes = getResidentBytes();
+
+    std::vector<std::unique_ptr<Instance>> instances;
+    int maxSustainable = 0;
+
+    std::cout << juce::String::formatted("%9s %9s %9s %9s %9s %12s", "instances", "mean ms", "worst ms", "budget", "misses", "KB/instance") << std::endl;
+
+    // every count up to 8, then roughly 25% steps so big runs don't take all day
+    for (int count = 1; count <= options.maxInstances; count = count < 8 ? count + 1 : juce::jmin(options.maxInstances + 1, count + count / 4))
+    {
+        while (static_cast<int>(instances.size()) < count)
+        {
+            juce::String error;
+            auto instance = createInstance(formatManager, description, options, error);
+
+            if (instance == nullptr)
+            {
+                std::cout << "Couldn't create instance " << instances.size() + 1 << ": " << error << std::endl;
+                break;
+            }
+
+            instances.push_back(std::move(instance));
+        }
+
+        if (static_cast<int>(instances.size()) < count)
+            break;
+
+        const auto result = runSchedule(instances, workers, options);
+        const auto bytesPerInstance = baselineBytes > 0 ? (getResidentBytes() - baselineBytes) / count : 0;
+
+        std::cout << juce::String::formatted("%9d %9.3f %9.3f %9.3f %9d %12lld",
+            count,
+            result.meanCycleMs,
+            result.worstCycleMs,
+            1000.0 * options.blockSize / options.sampleRate * options.load,
+            result.deadlineMisses,
+            (long long)(bytesPerInstance / 1024)) << std::endl;
+
+        if (result.deadlineMisses > 0)
+            break;
+
+        maxSustainable = count;
+    }
+
+    for (auto* worker : workers)
+        worker->stopThread(1000);
+
+    for (auto& instance : instances)
+        instance->plugin->releaseResources();
+
+    instances.clear();
+
+    std::cout << "Max sustainable instances: " << maxSustainable << std::endl;
+    return 0;
+}
@@ -0,0 +1,451 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    Long running soak test. Loads the built plugin through the regular plugin
+    hosting code like HostBenchmark does, then keeps a set of instances busy
+    with random automation (slope switches included), prepareToPlay with new
+    rates and block sizes, odd block lengths and NaN, Inf and denormal input,
+    for as long as asked. Every report interval it prints throughput, the CPU
+    time per sample against the first interval and resident memory against
+    the start, and it keeps count of non finite output and of instances that
+    went silent and stayed that way.
+
+    The blocks run on their own thread while the main thread dispatches
+    messages, so whatever the plugin hands to its message thread (the
+    snapshot pushes) really happens. Those come back as parameter changes
+    from the plugin, which get counted: without them a designer that's
+    waiting on one would stop designing altogether.
+
+    SoakTest --plugin path/to/KirbEqualizer.vst3
+             [--instances 8] [--seconds 3600] [--report 60] [--seed 1]
+
+    Exits non zero if any output was non finite, an instance got stuck or
+    snapshot switches never got pushed back.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include <thread>
+
+#if JUCE_LINUX
+ #include <unistd.h>
+#endif
+
+namespace
+{
+    struct Options
+    {
+        juce::String pluginPath;
+        int numInstances = 8;
+        double seconds = 3600;
+        double reportSeconds = 60;
+        juce::int64 seed = 1;
+    };
+
+    const std::array<double, 6> sampleRates{ 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+    const std::array<int, 7> blockSizes{ 32, 64, 128, 256, 512, 1024, 2048 };
+
+    // Resident set size of the whole process, only known on Linux
+    juce::int64 getResidentBytes()
+    {
+       #if JUCE_LINUX
+        juce::StringArray fields;
+        fields.addTokens(juce::File("/proc/self/statm").loadFileAsString(), " ", {});
+
+        if (fields.size() > 1)
+            return fields[1].getLargeIntValue() * static_cast<juce::int64>(sysconf(_SC_PAGESIZE));
+       #endif
+
+        return 0;
+    }
+
+    // Parameter changes coming from the plugin itself. Nothing here moves a parameter with notification,
+    // so these are the snapshot pushes, which only happen once the message loop got to them.
+    struct PushCounter : juce::AudioProcessorListener
+    {
+        void audioProcessorParameterChanged(juce::AudioProcessor*, int, float) override { ++numChanges; }
+        void audioProcessorChanged(juce::AudioProcessor*, const ChangeDetails&) override {}
+
+        std::atomic<int> numChanges{ 0 };
+    };
+
+    struct Instance
+    {
+        PushCounter pushes; // goes after the plugin
+        std::unique_ptr<juce::AudioPluginInstance> plugin;
+        juce::AudioBuffer<float> buffer;
+        juce::MidiBuffer midi;
+
+        double sampleRate = 48000;
+        int blockSize = 512;
+
+        juce::Array<juce::AudioProcessorParameter*> slopes; // the cut slopes, switched more often than the rest
+        juce::AudioProcessorParameter* snapshot = nullptr;
+
+        // Seconds of clean input since the last block that came out all zeros, a block with bad
+        // input in it or the last prepare. The output guard silences one block, not minutes of them.
+        double secondsSilent = 0;
+        bool stuck = false;
+    };
+
+    struct Totals
+    {
+        juce::int64 samplesProcessed = 0; // instances x channels x samples
+        double processSeconds = 0;
+        int numPrepares = 0, numBadInputBlocks = 0, numNonFinite = 0, numStuck = 0;
+        int numSnapshotSwitches = 0, numPushed = 0;
+
+        void add(const Totals& other)
+        {
+            samplesProcessed += other.samplesProcessed;
+            processSeconds += other.processSeconds;
+            numPrepares += other.numPrepares;
+            numBadInputBlocks += other.numBadInputBlocks;
+            numNonFinite += other.numNonFinite;
+            numStuck += other.numStuck;
+            numSnapshotSwitches += other.numSnapshotSwitches;
+            numPushed += other.numPushed;
+        }
+    };
+
+    enum InputKind
+    {
+        Input_Noise,
+        Input_NaN,
+        Input_Inf,
+        Input_Denormal,
+        Input_Silence
+    };
+
+    // Noise most of the time, now and then something a broken upstream plugin might send
+    InputKind fillInput(juce::AudioBuffer<float>& buffer, int numSamples, juce::Random& random)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                buffer.setSample(channel, i, random.nextFloat() * 0.5f - 0.25f);
+
+        const auto roll = random.nextInt(1000);
+        auto* samples = buffer.getWritePointer(random.nextInt(buffer.getNumChannels()));
+
+        if (roll < 2)
+        {
+            samples[random.nextInt(numSamples)] = std::numeric_limits<float>::quiet_NaN();
+            return Input_NaN;
+        }
+
+        if (roll < 4)
+        {
+            samples[random.nextInt(numSamples)] = random.nextBool() ? std::numeric_limits<float>::infinity()
+                                                                    : -std::numeric_limits<float>::infinity();
+            return Input_Inf;
+        }
+
+        if (roll < 14)
+        {
+            // the whole block in the subnormal range, where an unflushed filter slows right down
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    buffer.setSample(channel, i, (random.nextFloat() - 0.5f) * 1.0e-39f);
+
+            return Input_Denormal;
+        }
+
+        if (roll < 24)
+        {
+            buffer.clear(0, numSamples);
+            return Input_Silence;
+        }
+
+        return Input_Noise;
+    }
+
+    void prepare(Instance& instance, double sampleRate, int blockSize)
+    {
+        auto& plugin = *instance.plugin;
+
+        plugin.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        plugin.prepareToPlay(sampleRate, blockSize);
+
+        const auto numChannels = juce::jmax(plugin.getTotalNumInputChannels(), plugin.getTotalNumOutputChannels());
+        instance.buffer.setSize(numChannels, blockSize);
+
+        instance.sampleRate = sampleRate;
+        instance.blockSize = blockSize;
+        instance.secondsSilent = 0;
+    }
+
+    // A few parameters per block, slopes more often since their fallthrough switch is what changes
+    // the number of running sections
+    void automate(Instance& instance, Totals& totals, juce::Random& random)
+    {
+        const auto& parameters = instance.plugin->getParameters();
+
+        if (random.nextInt(4) == 0 && !parameters.isEmpty())
+        {
+            for (int i = random.nextInt(3); i >= 0; --i)
+            {
+                auto* parameter = parameters[random.nextInt(parameters.size())];
+                const auto before = parameter->getText(parameter->getValue(), 64);
+
+                parameter->setValue(random.nextFloat());
+
+                if (parameter == instance.snapshot && parameter->getText(parameter->getValue(), 64) != before)
+                    ++totals.numSnapshotSwitches;
+            }
+        }
+
+        if (random.nextInt(20) == 0 && !instance.slopes.isEmpty())
+            instance.slopes[random.nextInt(instance.slopes.size())]->setValue(random.nextFloat());
+    }
+
+    std::unique_ptr<Instance> createInstance(juce::AudioPluginFormatManager& formatManager,
+        const juce::PluginDescription& description,
+        juce::String& error)
+    {
+        auto instance = std::make_unique<Instance>();
+        instance->plugin = formatManager.createPluginInstance(description, instance->sampleRate, instance->blockSize, error);
+
+        if (instance->plugin == nullptr)
+            return {};
+
+        for (auto* parameter : instance->plugin->getParameters())
+            if (parameter->getName(64).endsWith("Cut Slope"))
+                instance->slopes.add(parameter);
+            else if (parameter->getName(64) == "Snapshot")
+                instance->snapshot = parameter;
+
+        instance->plugin->addListener(&instance->pushes);
+
+        instance->midi.ensureSize(256);
+        prepare(*instance, instance->sampleRate, instance->blockSize);
+
+        return instance;
+    }
+
+    // One block for one instance, with whatever changes this block brings
+    void runBlock(Instance& instance, Totals& totals, juce::Random& random)
+    {
+        // a host changing its setup, or going through releaseResources first
+        if (random.nextInt(5000) == 0)
+        {
+            if (random.nextBool())
+                instance.plugin->releaseResources();
+
+            prepare(instance,
+                sampleRates[static_cast<size_t>(random.nextInt(static_cast<int>(sampleRates.size())))],
+                blockSizes[static_cast<size_t>(random.nextInt(static_cast<int>(blockSizes.size())))]);
+
+            ++totals.numPrepares;
+        }
+
+        automate(instance, totals, random);
+
+        // mostly full blocks, sometimes anything shorter down to a single sample
+        const auto numSamples = random.nextInt(4) == 0 ? 1 + random.nextInt(instance.blockSize) : instance.blockSize;
+        const auto input = fillInput(instance.buffer, numSamples, random);
+
+        if (input == Input_NaN || input == Input_Inf)
+            ++totals.numBadInputBlocks;
+
+        juce::AudioBuffer<float> block(instance.buffer.getArrayOfWritePointers(), instance.buffer.getNumChannels(), numSamples);
+        instance.midi.clear();
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        instance.plugin->processBlock(block, instance.midi);
+        totals.processSeconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        totals.samplesProcessed += static_cast<juce::int64>(numSamples) * block.getNumChannels();
+
+        bool allZero = true;
+
+        for (int channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            const auto* samples = block.getReadPointer(channel);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                totals.numNonFinite += std::isfinite(samples[i]) ? 0 : 1;
+                allZero = allZero && samples[i] == 0.f;
+            }
+        }
+
+        // Filtered noise doesn't come out as exact zeros, the output guard's cleared blocks do
+        if (input != Input_Noise || !allZero)
+        {
+            instance.secondsSilent = 0;
+            instance.stuck = false;
+            return;
+        }
+
+        instance.secondsSilent += numSamples / instance.sampleRate;
+
+        if (instance.secondsSilent > 10.0 && !instance.stuck)
+        {
+            instance.stuck = true;
+            ++totals.numStuck;
+        }
+    }
+
+    // Runs the blocks until the time is up, printing a line every report interval
+    Totals soak(std::vector<std::unique_ptr<Instance>>& instances, const Options& options, juce::Random& random, juce::int64 startBytes)
+    {
+        std::cout << juce::String::formatted("%9s %14s %10s %8s %9s %9s %9s %9s %9s %9s", "seconds", "samples/s", "ns/sample", "drift %",
+            "MB grown", "prepares", "bad in", "non fin", "switches", "pushed") << std::endl;
+
+        Totals totals, interval;
+        double firstNsPerSample = 0;
+
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+        auto nextReport = start + options.reportSeconds * 1000.0;
+
+        for (;;)
+        {
+            auto now = juce::Time::getMillisecondCounterHiRes();
+            const auto finished = now - start >= options.seconds * 1000.0;
+
+            if (!finished)
+            {
+                for (auto& instance : instances)
+                    runBlock(*instance, interval, random);
+
+                now = juce::Time::getMillisecondCounterHiRes();
+
+                if (now < nextReport)
+                    continue;
+            }
+
+            // parameters the plugins pushed back since the last report, i.e. switches their designers got through
+            for (auto& instance : instances)
+                interval.numPushed += instance->pushes.numChanges.exchange(0);
+
+            // instances x channels x samples per second of processing time, and what each of those cost
+            const auto throughput = interval.processSeconds > 0 ? interval.samplesProcessed / interval.processSeconds : 0.0;
+            const auto nsPerSample = interval.samplesProcessed > 0 ? 1.0e9 * interval.processSeconds / interval.samplesProcessed : 0.0;
+
+            if (firstNsPerSample == 0)
+                firstNsPerSample = nsPerSample;
+
+            const auto drift = firstNsPerSample > 0 ? 100.0 * (nsPerSample / firstNsPerSample - 1.0) : 0.0;
+            const auto grownBytes = startBytes > 0 ? getResidentBytes() - startBytes : 0;
+
+            if (!finished)
+                std::cout << juce::String::formatted("%9.0f %14.0f %10.3f %8.1f %9.2f %9d %9d %9d %9d %9d",
+                    (now - start) / 1000.0, throughput, nsPerSample, drift, grownBytes / (1024.0 * 1024.0),
+                    interval.numPrepares, interval.numBadInputBlocks, interval.numNonFinite,
+                    interval.numSnapshotSwitches, interval.numPushed) << std::endl;
+
+            totals.add(interval);
+            interval = {};
+
+            if (finished)
+                return totals;
+
+            nextReport = now + options.reportSeconds * 1000.0;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; // plugin hosting wants a message manager around
+
+    juce::ArgumentList args(argc, argv);
+    Options options;
+
+    options.pluginPath = args.getValueForOption("--plugin");
+
+    if (options.pluginPath.isEmpty())
+    {
+        std::cout << "Usage: SoakTest --plugin <path> [--instances N] [--seconds S] [--report S] [--seed N]" << std::endl;
+        return 1;
+    }
+
+    if (args.containsOption("--instances")) options.numInstances = juce::jmax(1, args.getValueForOption("--instances").getIntValue());
+    if (args.containsOption("--seconds")) options.seconds = args.getValueForOption("--seconds").getDoubleValue();
+    if (args.containsOption("--report")) options.reportSeconds = juce::jmax(1.0, args.getValueForOption("--report").getDoubleValue());
+    if (args.containsOption("--seed")) options.seed = args.getValueForOption("--seed").getLargeIntValue();
+
+    juce::AudioPluginFormatManager formatManager;
+    formatManager.addDefaultFormats();
+
+    juce::OwnedArray<juce::PluginDescription> descriptions;
+
+    for (auto* format : formatManager.getFormats())
+        format->findAllTypesForFile(descriptions, options.pluginPath);
+
+    if (descriptions.isEmpty())
+    {
+        std::cout << "No plugin found in " << options.pluginPath << std::endl;
+        return 1;
+    }
+
+    const auto& description = *descriptions.getFirst();
+    std::cout << "Soaking " << options.numInstances << " instances of " << description.name << " (" << description.pluginFormatName
+              << ") for " << options.seconds << " s, seed " << options.seed << std::endl;
+
+    juce::Random random(options.seed);
+
+    // loaded once and thrown away, so the plugin's own statics don't count as growth
+    {
+        juce::String error;
+        createInstance(formatManager, description, error);
+    }
+
+    const auto baselineBytes = getResidentBytes();
+
+    std::vector<std::unique_ptr<Instance>> instances;
+
+    for (int i = 0; i < options.numInstances; ++i)
+    {
+        juce::String error;
+        auto instance = createInstance(formatManager, description, error);
+
+        if (instance == nullptr)
+        {
+            std::cout << "Couldn't create instance " << i + 1 << ": " << error << std::endl;
+            return 1;
+        }
+
+        instances.push_back(std::move(instance));
+    }
+
+    const auto startBytes = getResidentBytes();
+
+    // The audio side runs on its own thread, this one dispatches messages until it's done
+    Totals totals;
+
+    std::thread soakThread([&]
+        {
+            totals = soak(instances, options, random, startBytes);
+            juce::MessageManager::getInstance()->stopDispatchLoop();
+        });
+
+    juce::MessageManager::getInstance()->runDispatchLoop();
+    soakThread.join();
+
+    for (auto& instance : instances)
+        instance->plugin->releaseResources();
+
+    instances.clear();
+
+    // whatever the instances didn't give back (allocators keep some, so it's only a hint on its own)
+    const auto leakedBytes = baselineBytes > 0 ? getResidentBytes() - baselineBytes : 0;
+
+    std::cout << "Throughput: " << juce::String(totals.processSeconds > 0 ? totals.samplesProcessed / totals.processSeconds : 0.0, 0)
+              << " instance channel samples/s" << std::endl
+              << "Not given back after deleting the instances: " << juce::String(leakedBytes / 1024.0, 1) << " KB" << std::endl
+              << "Non finite output samples: " << totals.numNonFinite << std::endl
+              << "Instances stuck silent: " << totals.numStuck << std::endl
+              << "Snapshot switches: " << totals.numSnapshotSwitches << ", parameters pushed back: " << totals.numPushed << std::endl;
+
+    // switches that never came back means the designers sat waiting on them and stopped designing
+    const bool designersStalled = totals.numSnapshotSwitches > 0 && totals.numPushed == 0;
+
+    if (designersStalled)
+        std::cout << "Nothing was pushed back after a snapshot switch" << std::endl;
+
+    return totals.numNonFinite == 0 && totals.numStuck == 0 && !designersStalled ? 0 : 1;
+}